@@ -0,0 +1,128 @@
+// Replaces the global operator new/delete of the benchmark executable to count heap allocations.
+// The replacement also covers allocations made inside libMarginCallReport.so.
+
+#include "AllocCounter.hpp"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> allocations_count{0};
+    std::atomic<size_t> allocations_bytes{0};
+    std::atomic<size_t> live_bytes{0};
+
+    std::array<std::atomic<size_t>, bench::kTrackedSizes> size_counts{};
+
+    void* CountedAlloc(const std::size_t size) {
+        allocations_count.fetch_add(1, std::memory_order_relaxed);
+        allocations_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (size < bench::kTrackedSizes) {
+            size_counts[size].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+            live_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* CountedAlignedAlloc(const std::size_t size, const std::align_val_t alignment) {
+        const auto align = static_cast<std::size_t>(alignment);
+        if (align <= alignof(std::max_align_t)) {
+            return CountedAlloc(size);
+        }
+
+        allocations_count.fetch_add(1, std::memory_order_relaxed);
+        allocations_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (size < bench::kTrackedSizes) {
+            size_counts[size].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // aligned_alloc требует размер, кратный выравниванию
+        const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+        if (void* ptr = std::aligned_alloc(align, rounded)) {
+            live_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    void CountedFree(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        live_bytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+        std::free(ptr);
+    }
+} // namespace
+
+namespace bench {
+    AllocStats AllocationsSnapshot() {
+        return {allocations_count.load(std::memory_order_relaxed),
+                allocations_bytes.load(std::memory_order_relaxed)};
+    }
+
+    size_t AllocationsOfSize(const size_t size) {
+        return size < kTrackedSizes ? size_counts[size].load(std::memory_order_relaxed) : 0;
+    }
+
+    size_t LiveHeapBytes() {
+        return live_bytes.load(std::memory_order_relaxed);
+    }
+} // namespace bench
+
+void* operator new(std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    CountedFree(ptr);
+}
+
+// Aligned forms: std::pmr::new_delete_resource() allocates through them
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    CountedFree(ptr);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bench {
+    struct AllocStats {
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    // Global operator new calls since process start (see AllocCounter.cpp)
+    AllocStats AllocationsSnapshot();
+
+    // operator new calls of exactly size bytes since process start (size < kTrackedSizes)
+    inline constexpr size_t kTrackedSizes = 256;
+    size_t AllocationsOfSize(size_t size);
+
+    // Heap bytes currently held through operator new (usable size of the live blocks)
+    size_t LiveHeapBytes();
+
+    inline AllocStats AllocationsSince(const AllocStats& start) {
+        const AllocStats now = AllocationsSnapshot();
+        return {now.count - start.count, now.bytes - start.bytes};
+    }
+} // namespace bench
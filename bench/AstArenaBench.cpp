@@ -0,0 +1,139 @@
+// Margin call table of 20k rows and a totals block of 2k currencies built as an ast tree
+// (TableBuilder::AddRow -> CreateTableProps -> ast::Node -> to_json) with ast containers on the
+// heap and inside a per-request ScopedArena, with the default retained buffer and with one large
+// enough for the whole tree. Checks that both produce byte-identical JSON and reports wall time
+// and heap allocations of building, serializing and destroying the tree.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.hpp"
+#include "BenchSupport.hpp"
+#include "ast/Arena.hpp"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "utils/Utils.h"
+
+namespace {
+    constexpr size_t kRowsCount       = 20000;
+    constexpr size_t kCurrenciesCount = 2000;
+    constexpr int    kRepetitions     = 7;
+
+    void BuildReport(Document& document) {
+        TableBuilder table_builder("MarginCallReportTable");
+
+        FilterConfig search_filter;
+        search_filter.type = FilterType::Search;
+
+        table_builder.SetIdColumn("login");
+        table_builder.SetOrderBy("login", "DESC");
+        table_builder.EnableTotal(true);
+        table_builder.SetTotalDataTitle("TOTAL");
+
+        table_builder.AddColumn({"login", "LOGIN", 1, search_filter});
+        table_builder.AddColumn({"name", "NAME", 2, search_filter});
+        table_builder.AddColumn({"leverage", "LEVERAGE", 3, search_filter});
+        table_builder.AddColumn({"balance", "BALANCE", 4, search_filter});
+        table_builder.AddColumn({"equity", "EQUITY", 5, search_filter});
+        table_builder.AddColumn({"margin", "MARGIN", 6, search_filter});
+        table_builder.AddColumn({"currency", "CURRENCY", 7, search_filter});
+
+        for (size_t i = 0; i < kRowsCount; ++i) {
+            const double balance = 1000.0 + static_cast<double>(i) * 0.37;
+            table_builder.AddRow({static_cast<int64_t>(100000 + i),
+                                  "Account holder name #" + std::to_string(i),
+                                  static_cast<int64_t>(100),
+                                  utils::TruncateDouble(balance, 2),
+                                  utils::TruncateDouble(balance * 0.4, 2),
+                                  utils::TruncateDouble(balance * 0.6, 2),
+                                  "CUR" + std::to_string(i % kCurrenciesCount)});
+        }
+
+        JSONArray totals_array;
+        for (size_t i = 0; i < kCurrenciesCount; ++i) {
+            totals_array.emplace_back(JSONObject{{"balance", 1000.0 * static_cast<double>(i)},
+                                                 {"equity", 400.0 * static_cast<double>(i)},
+                                                 {"margin", 600.0 * static_cast<double>(i)},
+                                                 {"currency", "CUR" + std::to_string(i)}});
+        }
+        table_builder.SetTotalData(std::move(totals_array));
+
+        const Node report =
+            Column({h1({text("Margin Call Report")}),
+                    Table({}, std::move(table_builder).CreateTableProps())});
+
+        document.SetObject();
+        utils::CreateUI(report, document, document.GetAllocator());
+    }
+
+    void BuildOnHeap(Document& document) { BuildReport(document); }
+
+    void BuildInArena(Document& document) {
+        ScopedArena arena;
+        BuildReport(document);
+    }
+
+    std::string Serialize(const Document& document) {
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        document.Accept(writer);
+        return buffer.GetString();
+    }
+
+    template <typename Build>
+    void Measure(const char* name, Build build) {
+        const bench::AllocStats start = bench::AllocationsSnapshot();
+        {
+            Document document;
+            build(document);
+        }
+        const bench::AllocStats allocations = bench::AllocationsSince(start);
+
+        const bench::Timing timing = bench::Sample(kRepetitions, [&] {
+            Document document;
+            build(document);
+            bench::DoNotOptimize(document.MemberCount());
+        });
+
+        std::printf("%-28s %10zu %14.3f %12.3f\n",
+                    name,
+                    kRowsCount,
+                    timing.min_ms,
+                    timing.median_ms);
+        std::printf("%-28s %10zu allocations, %zu bytes\n",
+                    "",
+                    allocations.count,
+                    allocations.bytes);
+    }
+} // namespace
+
+int main() {
+    Document heap_document;
+    BuildOnHeap(heap_document);
+
+    Document arena_document;
+    BuildInArena(arena_document);
+
+    const std::string heap_json  = Serialize(heap_document);
+    const std::string arena_json = Serialize(arena_document);
+
+    if (heap_json != arena_json) {
+        std::fprintf(stderr, "arena ast output differs from the heap ast output\n");
+        return 1;
+    }
+
+    std::printf("\n== ast arena, %zu bytes of JSON ==\n", heap_json.size());
+    std::printf("%-28s %10s %14s %12s\n", "case", "rows", "min, ms", "median, ms");
+    Measure("ast on heap", BuildOnHeap);
+    Measure("ast in ScopedArena", BuildInArena);
+
+    // Дерево на 20k строк больше буфера по умолчанию: с буфером под весь запрос
+    ScopedArena::SetMaxRetainedSize(64 * 1024 * 1024);
+    Measure("ast in ScopedArena, 64 MB", BuildInArena);
+    ScopedArena::ReleaseRetained();
+
+    return 0;
+}
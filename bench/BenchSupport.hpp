@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bench {
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the optimizer from dropping a computed value
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Runs fn `repetitions` times and returns the best wall time in nanoseconds
+    template <typename Fn>
+    inline double BestOf(const int repetitions, Fn&& fn) {
+        double best = 0.0;
+        for (int i = 0; i < repetitions; ++i) {
+            const auto start = Clock::now();
+            fn();
+            const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    struct Timing {
+        double min_ms    = 0.0;
+        double median_ms = 0.0;
+    };
+
+    // Runs fn `repetitions` times and returns the min and median wall time in milliseconds
+    template <typename Fn>
+    inline Timing Sample(const int repetitions, Fn&& fn) {
+        std::vector<double> samples;
+        samples.reserve(static_cast<size_t>(repetitions));
+
+        for (int i = 0; i < repetitions; ++i) {
+            const auto start = Clock::now();
+            fn();
+            const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+            samples.push_back(elapsed.count());
+        }
+
+        std::sort(samples.begin(), samples.end());
+        return {samples.front(), samples[samples.size() / 2]};
+    }
+
+    inline void PrintHeader(const std::string& title) {
+        std::printf("\n== %s ==\n", title.c_str());
+        std::printf("%-28s %10s %14s %12s\n", "case", "n", "total, ms", "ns/op");
+    }
+
+    inline void PrintRow(const std::string& name, const size_t n, const double total_ns) {
+        std::printf("%-28s %10zu %14.3f %12.2f\n",
+                    name.c_str(),
+                    n,
+                    total_ns / 1e6,
+                    n == 0 ? 0.0 : total_ns / static_cast<double>(n));
+    }
+} // namespace bench
@@ -0,0 +1,105 @@
+// Truncation and formatting of monetary values: std::pow-based truncation printed by
+// rapidjson's double writer (the previous TruncateDouble path) against ast::Decimal with its
+// integer-to-decimal writer. Also counts values the std::pow path truncated one cent low.
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "ast/Decimal.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    constexpr size_t kValuesCount = 1000000;
+    constexpr int    kRepetitions = 5;
+
+    // Прежняя реализация utils::TruncateDouble
+    double PowTruncate(const double value, const int digits) {
+        const double factor = std::pow(10.0, digits);
+        return std::trunc(value * factor) / factor;
+    }
+
+    // Балансы с копейками, как их отдает сервер: десятичное значение, округленное до double
+    std::vector<double> MakeValues() {
+        std::mt19937_64                         rng(42);
+        std::uniform_int_distribution<int64_t> cents(-100000000, 1000000000);
+
+        std::vector<double> values(kValuesCount);
+        for (auto& value : values) {
+            value = static_cast<double>(cents(rng)) / 100.0;
+        }
+        return values;
+    }
+} // namespace
+
+int main() {
+    const std::vector<double> values = MakeValues();
+
+    size_t pow_bytes     = 0;
+    size_t decimal_bytes = 0;
+    size_t cent_low      = 0;
+
+    for (const double value : values) {
+        if (PowTruncate(value, 2) != ast::Decimal::Truncate(value, 2).ToDouble()) {
+            ++cent_low;
+        }
+    }
+
+    bench::PrintHeader("decimal, " + std::to_string(kValuesCount) + " values");
+
+    const double pow_truncate = bench::BestOf(kRepetitions, [&] {
+        double sum = 0.0;
+        for (const double value : values) {
+            sum += PowTruncate(value, 2);
+        }
+        bench::DoNotOptimize(sum);
+    });
+    bench::PrintRow("std::pow truncate", values.size(), pow_truncate);
+
+    const double decimal_truncate = bench::BestOf(kRepetitions, [&] {
+        int64_t sum = 0;
+        for (const double value : values) {
+            sum += ast::Decimal::Truncate(value, 2).units;
+        }
+        bench::DoNotOptimize(sum);
+    });
+    bench::PrintRow("Decimal::Truncate", values.size(), decimal_truncate);
+
+    const double pow_format = bench::BestOf(kRepetitions, [&] {
+        rapidjson::StringBuffer                    buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartArray();
+        for (const double value : values) {
+            writer.Double(PowTruncate(value, 2));
+        }
+        writer.EndArray(static_cast<rapidjson::SizeType>(values.size()));
+        pow_bytes = buffer.GetSize();
+    });
+    bench::PrintRow("std::pow + Writer::Double", values.size(), pow_format);
+
+    const double decimal_format = bench::BestOf(kRepetitions, [&] {
+        std::string buffer;
+        buffer.reserve(values.size() * ast::Decimal::kMaxChars);
+        buffer.push_back('[');
+        char text[ast::Decimal::kMaxChars];
+        for (const double value : values) {
+            if (buffer.size() > 1) {
+                buffer.push_back(',');
+            }
+            buffer.append(text, ast::Decimal::Truncate(value, 2).Write(text));
+        }
+        buffer.push_back(']');
+        decimal_bytes = buffer.size();
+        bench::DoNotOptimize(buffer.data());
+    });
+    bench::PrintRow("Decimal::Write", values.size(), decimal_format);
+
+    std::printf("%-28s %10zu bytes\n", "Writer::Double output", pow_bytes);
+    std::printf("%-28s %10zu bytes\n", "Decimal::Write output", decimal_bytes);
+    std::printf("%-28s %10zu values\n", "std::pow truncated low", cent_low);
+
+    return 0;
+}
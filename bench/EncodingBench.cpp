@@ -0,0 +1,355 @@
+// Margin call table of 50k rows in typed TableBuilder columns (as in CreateReport) encoded as
+// the ui payload: rapidjson DOM + Writer (current response), SAX JSON (__accept_serialized),
+// CBOR and CBOR + base64 (__encoding: "cbor"). Reports encode time and size, then decode time
+// on the client side: rapidjson Parse of the JSON against a minimal CBOR reader that builds the
+// same Document. Checks that SAX JSON is byte-identical to the DOM JSON and that the decoded CBOR
+// equals the parsed JSON. The currency column is a ColumnType::Dictionary column; the
+// dictionary-encoded rows (__dictionary_encoding) are timed and sized against it as well.
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "encoding/CborWriter.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "utils/Utils.h"
+
+namespace {
+    constexpr size_t kRowsCount   = 50000;
+    constexpr int    kRepetitions = 5;
+
+    TableBuilder MakeTable() {
+        FilterConfig search_filter;
+        search_filter.type = FilterType::Search;
+
+        TableBuilder table_builder("MarginCallReportTable");
+        table_builder.SetIdColumn("login");
+        table_builder.SetOrderBy("login", "DESC");
+        table_builder.EnableTotal(true);
+        table_builder.SetTotalDataTitle("TOTAL");
+
+        table_builder.AddColumn({"login", "LOGIN", 1, search_filter}, ColumnType::Int64);
+        table_builder.AddColumn({"name", "NAME", 2, search_filter}, ColumnType::String);
+        table_builder.AddColumn({"leverage", "LEVERAGE", 3, search_filter}, ColumnType::Int64);
+        table_builder.AddColumn({"balance", "BALANCE", 4, search_filter}, ColumnType::Decimal);
+        table_builder.AddColumn({"credit", "CREDIT", 5, search_filter}, ColumnType::Decimal);
+        table_builder.AddColumn({"equity", "EQUITY", 6, search_filter}, ColumnType::Decimal);
+        table_builder.AddColumn({"margin", "MARGIN", 7, search_filter}, ColumnType::Decimal);
+        table_builder.AddColumn({"margin_level", "MARGIN_LEVEL", 8, search_filter},
+                                ColumnType::Decimal);
+        table_builder.AddColumn({"currency", "CURRENCY", 9, search_filter},
+                                ColumnType::Dictionary);
+        table_builder.FreezeStructure();
+
+        table_builder.ReserveRows(kRowsCount);
+        for (size_t i = 0; i < kRowsCount; ++i) {
+            const double balance = 1000.0 + static_cast<double>(i) * 0.37;
+            table_builder.AppendRow(static_cast<int64_t>(100000 + i),
+                                    "Account holder #" + std::to_string(i),
+                                    static_cast<int64_t>(100),
+                                    Decimal::Truncate(balance, 2),
+                                    Decimal::Truncate(static_cast<double>(i % 50), 2),
+                                    Decimal::Truncate(balance * 0.4, 2),
+                                    Decimal::Truncate(balance * 0.6, 2),
+                                    Decimal::Truncate(66.666, 2),
+                                    i % 3 == 0 ? "EUR" : "USD");
+        }
+        return table_builder;
+    }
+
+    template <typename Handler>
+    bool WriteContent(const TableBuilder& table_builder, Handler& handler) {
+        return handler.StartObject() &&
+               handler.Key("type") && handler.String("Column") &&
+               handler.Key("children") && handler.StartArray() &&
+               write_json(h1({text("Margin Call Report")}), handler) &&
+               handler.StartObject() &&
+               handler.Key("type") && handler.String("Table") &&
+               handler.Key("props") && table_builder.StreamTableProps(handler) &&
+               handler.EndObject() &&
+               handler.EndArray() &&
+               handler.EndObject();
+    }
+
+    // Текущий ответ: ui строится в Document, хост сериализует его Writer'ом
+    std::string EncodeJsonDom(const TableBuilder& table_builder) {
+        Document document;
+        auto&    allocator = document.GetAllocator();
+
+        Value table_props(kObjectType);
+        table_builder.WriteTableProps(table_props, allocator);
+
+        Value table_object(kObjectType);
+        table_object.AddMember("type", "Table", allocator);
+        table_object.AddMember("props", table_props, allocator);
+
+        Value report_object;
+        to_json(Column({h1({text("Margin Call Report")})}), report_object, allocator);
+        report_object["children"].PushBack(table_object, allocator);
+
+        document.SetObject();
+        utils::CreateUI(report_object, document, allocator);
+
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        document["ui"].Accept(writer);
+        return {buffer.GetString(), buffer.GetSize()};
+    }
+
+    std::string EncodeJsonSax(const TableBuilder& table_builder) {
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        utils::WriteUI(writer, [&](auto& handler) { return WriteContent(table_builder, handler); });
+        return {buffer.GetString(), buffer.GetSize()};
+    }
+
+    std::string EncodeCbor(const TableBuilder& table_builder) {
+        std::string          cbor;
+        encoding::CborWriter writer(cbor);
+        utils::WriteUI(writer, [&](auto& handler) { return WriteContent(table_builder, handler); });
+        return cbor;
+    }
+
+    std::string EncodeCborBase64(const TableBuilder& table_builder) {
+        const std::string cbor = EncodeCbor(table_builder);
+
+        std::string base64(encoding::Base64Size(cbor.size()), '\0');
+        encoding::Base64Encode(
+            reinterpret_cast<const uint8_t*>(cbor.data()), cbor.size(), base64.data());
+        return base64;
+    }
+
+    // Минимальный CBOR-читатель: ровно то, что пишет CborWriter, SAX-событиями в Handler
+    class CborReader {
+    public:
+        CborReader(const std::string& data) : _data(reinterpret_cast<const uint8_t*>(data.data())),
+                                              _end(_data + data.size()) {}
+
+        // Генератор для Document::Populate
+        template <typename Handler>
+        bool operator()(Handler& handler) {
+            ReadItem(handler);
+            if (_data != _end) {
+                throw std::runtime_error("trailing bytes after CBOR item");
+            }
+            return true;
+        }
+
+    private:
+        const uint8_t* _data;
+        const uint8_t* _end;
+
+        uint8_t Byte() {
+            if (_data == _end) {
+                throw std::runtime_error("truncated CBOR");
+            }
+            return *_data++;
+        }
+
+        uint64_t BigEndian(const int bytes) {
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value = (value << 8) | Byte();
+            }
+            return value;
+        }
+
+        uint64_t Argument(const uint8_t info) {
+            switch (info) {
+                case 24: return BigEndian(1);
+                case 25: return BigEndian(2);
+                case 26: return BigEndian(4);
+                case 27: return BigEndian(8);
+                default: return info;
+            }
+        }
+
+        // false - встретился break (0xff)
+        template <typename Handler>
+        bool ReadItem(Handler& handler, const bool as_key = false) {
+            const uint8_t head  = Byte();
+            const uint8_t major = head >> 5;
+            const uint8_t info  = head & 0x1f;
+
+            if (head == 0xff) {
+                return false;
+            }
+
+            switch (major) {
+                case 0: handler.Uint64(Argument(info)); return true;
+                case 1: handler.Int64(-1 - static_cast<int64_t>(Argument(info))); return true;
+                case 3: {
+                    const auto length = static_cast<SizeType>(Argument(info));
+                    if (static_cast<size_t>(_end - _data) < length) {
+                        throw std::runtime_error("truncated CBOR string");
+                    }
+                    const auto* str = reinterpret_cast<const char*>(_data);
+                    _data += length;
+                    as_key ? handler.Key(str, length, true) : handler.String(str, length, true);
+                    return true;
+                }
+                case 4: {
+                    handler.StartArray();
+                    SizeType count = 0;
+                    while (ReadItem(handler)) {
+                        ++count;
+                    }
+                    handler.EndArray(count);
+                    return true;
+                }
+                case 5: {
+                    handler.StartObject();
+                    SizeType count = 0;
+                    while (ReadItem(handler, true)) {
+                        ReadItem(handler);
+                        ++count;
+                    }
+                    handler.EndObject(count);
+                    return true;
+                }
+                case 6: return ReadTagged(handler, Argument(info));
+                case 7: return ReadSimple(handler, info);
+                default: throw std::runtime_error("unsupported CBOR major type");
+            }
+        }
+
+        int64_t ReadInteger() {
+            const uint8_t head = Byte();
+            switch (head >> 5) {
+                case 0: return static_cast<int64_t>(Argument(head & 0x1f));
+                case 1: return -1 - static_cast<int64_t>(Argument(head & 0x1f));
+                default: throw std::runtime_error("CBOR integer expected");
+            }
+        }
+
+        // Decimal fraction (tag 4): [показатель, мантисса] - так приходят Decimal-ячейки
+        template <typename Handler>
+        bool ReadTagged(Handler& handler, const uint64_t tag) {
+            if (tag != 4 || Byte() != 0x82) {
+                throw std::runtime_error("unsupported CBOR tag");
+            }
+            const int64_t exponent = ReadInteger();
+            const int64_t mantissa = ReadInteger();
+            if (exponent > 0 || exponent < -18) {
+                throw std::runtime_error("unsupported decimal fraction exponent");
+            }
+            int64_t scale = 1;
+            for (int64_t i = exponent; i < 0; ++i) {
+                scale *= 10;
+            }
+            // Деление на точную степень десяти округляет так же, как разбор текста
+            handler.Double(static_cast<double>(mantissa) / static_cast<double>(scale));
+            return true;
+        }
+
+        template <typename Handler>
+        bool ReadSimple(Handler& handler, const uint8_t info) {
+            switch (info) {
+                case 20: handler.Bool(false); return true;
+                case 21: handler.Bool(true); return true;
+                case 22: handler.Null(); return true;
+                case 26: {
+                    const auto bits = static_cast<uint32_t>(BigEndian(4));
+                    float      value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    handler.Double(value);
+                    return true;
+                }
+                case 27: {
+                    const uint64_t bits = BigEndian(8);
+                    double         value;
+                    std::memcpy(&value, &bits, sizeof(value));
+                    handler.Double(value);
+                    return true;
+                }
+                default: throw std::runtime_error("unsupported CBOR simple value");
+            }
+        }
+    };
+
+    void PrintSize(const char* name, const size_t bytes, const size_t json_bytes) {
+        std::printf("%-28s %10zu bytes, %.1f%% of JSON\n",
+                    name,
+                    bytes,
+                    100.0 * static_cast<double>(bytes) / static_cast<double>(json_bytes));
+    }
+} // namespace
+
+int main() {
+    const TableBuilder table_builder = MakeTable();
+
+    TableBuilder dictionary_table = table_builder;
+    dictionary_table.EnableDictionaryEncoding(true);
+
+    const std::string json_dom    = EncodeJsonDom(table_builder);
+    const std::string json_sax    = EncodeJsonSax(table_builder);
+    const std::string cbor        = EncodeCbor(table_builder);
+    const std::string cbor_base64 = EncodeCborBase64(table_builder);
+    const std::string json_codes  = EncodeJsonSax(dictionary_table);
+    const std::string cbor_codes  = EncodeCbor(dictionary_table);
+
+    Document from_json;
+    from_json.Parse(json_dom.c_str(), json_dom.size());
+
+    if (json_sax != json_dom) {
+        std::fprintf(stderr, "SAX JSON differs from the DOM JSON\n");
+        return 1;
+    }
+
+    Document   from_cbor;
+    CborReader cbor_reader(cbor);
+    from_cbor.Populate(cbor_reader);
+
+    if (from_json.HasParseError() || from_json != from_cbor) {
+        std::fprintf(stderr, "decoded CBOR differs from the parsed JSON\n");
+        return 1;
+    }
+
+    bench::PrintHeader("ui encoding, " + std::to_string(kRowsCount) + " rows");
+    bench::PrintRow("JSON, Document + Writer", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeJsonDom(table_builder).size());
+    }));
+    bench::PrintRow("JSON, SAX", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeJsonSax(table_builder).size());
+    }));
+    bench::PrintRow("CBOR", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeCbor(table_builder).size());
+    }));
+    bench::PrintRow("CBOR + base64", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeCborBase64(table_builder).size());
+    }));
+    bench::PrintRow("JSON, SAX, dictionary", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeJsonSax(dictionary_table).size());
+    }));
+    bench::PrintRow("CBOR, dictionary", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(EncodeCbor(dictionary_table).size());
+    }));
+
+    std::printf("\n");
+    PrintSize("JSON", json_dom.size(), json_dom.size());
+    PrintSize("CBOR", cbor.size(), json_dom.size());
+    PrintSize("CBOR + base64", cbor_base64.size(), json_dom.size());
+    PrintSize("JSON, dictionary", json_codes.size(), json_dom.size());
+    PrintSize("CBOR, dictionary", cbor_codes.size(), json_dom.size());
+
+    bench::PrintHeader("client decode into rapidjson::Document");
+    bench::PrintRow("JSON, Document::Parse", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        Document document;
+        document.Parse(json_dom.c_str(), json_dom.size());
+        bench::DoNotOptimize(document.MemberCount());
+    }));
+    bench::PrintRow("CBOR, CborReader", kRowsCount, bench::BestOf(kRepetitions, [&] {
+        Document   document;
+        CborReader reader(cbor);
+        document.Populate(reader);
+        bench::DoNotOptimize(document.MemberCount());
+    }));
+
+    return 0;
+}
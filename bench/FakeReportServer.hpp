@@ -0,0 +1,339 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ReportServerInterface.h"
+#include "structures/LoginIndex.hpp"
+#include "structures/ReportStructures.hpp"
+
+namespace bench {
+    // Параметры синтетической популяции
+    struct FakePopulation {
+        size_t   accounts             = 10000;
+        size_t   groups               = 50;
+        size_t   currencies           = 5;
+        double   margin_call_fraction = 0.01; // accounts in margin call or stop out
+        uint32_t seed                 = 42;
+    };
+
+    // Comma separated masks with '*' wildcards and '!' exclusions, "*" matches every group
+    inline bool MatchGroupMask(const std::string& mask, const std::string& group) {
+        const auto match = [](const char* pattern, const char* value, auto&& self) -> bool {
+            for (; *pattern != '\0'; ++pattern, ++value) {
+                if (*pattern == '*') {
+                    for (const char* rest = value;; ++rest) {
+                        if (self(pattern + 1, rest, self)) {
+                            return true;
+                        }
+                        if (*rest == '\0') {
+                            return false;
+                        }
+                    }
+                }
+                if (*value == '\0' || *pattern != *value) {
+                    return false;
+                }
+            }
+            return *value == '\0';
+        };
+
+        bool   matched = false;
+        size_t begin   = 0;
+        while (begin <= mask.size()) {
+            size_t end = mask.find(',', begin);
+            if (end == std::string::npos) {
+                end = mask.size();
+            }
+
+            std::string pattern = mask.substr(begin, end - begin);
+            while (!pattern.empty() && pattern.front() == ' ') {
+                pattern.erase(pattern.begin());
+            }
+            while (!pattern.empty() && pattern.back() == ' ') {
+                pattern.pop_back();
+            }
+
+            if (!pattern.empty()) {
+                const bool exclude = pattern.front() == '!';
+                if (exclude && match(pattern.c_str() + 1, group.c_str(), match)) {
+                    return false;
+                }
+                if (!exclude && match(pattern.c_str(), group.c_str(), match)) {
+                    matched = true;
+                }
+            }
+
+            begin = end + 1;
+        }
+        return matched;
+    }
+
+    // In-process ReportServerInterface serving a generated population.
+    // Only the calls used by the margin call report return data, the rest succeed empty.
+    class FakeReportServer : public ReportServerInterface {
+    public:
+        explicit FakeReportServer(const FakePopulation& population) { Generate(population); }
+
+        std::atomic<size_t> calls_count{0};
+
+        const std::vector<ReportAccountRecord>& Accounts() const { return _accounts; }
+
+        const std::vector<ReportGroupRecord>& Groups() const { return _groups; }
+
+        // Меняет equity аккаунта и пересчитывает уровень маржи по настройкам его группы, как
+        // сервер перед событием баланса; false - логина нет
+        bool SetEquity(const int login, const double equity) {
+            const uint32_t position = _logins.Find(login);
+            if (position == LoginIndex::kNotFound) {
+                return false;
+            }
+
+            ReportMarginLevel&       margin = _accounts[position].margin;
+            const ReportGroupRecord& group  = _groups[position % _groups.size()];
+
+            margin.equity       = equity;
+            margin.margin_free  = margin.equity - margin.margin;
+            margin.margin_level = margin.margin > 0 ? margin.equity / margin.margin * 100.0 : 0.0;
+
+            if (margin.margin_level >= group.margin_call) {
+                margin.level_type = MARGINLEVEL_OK;
+            } else if (margin.margin_level < group.margin_stopout) {
+                margin.level_type = MARGINLEVEL_STOPOUT;
+            } else {
+                margin.level_type = MARGINLEVEL_MARGINCALL;
+            }
+            return true;
+        }
+
+        int GetLogs(time_t, time_t, const std::string&, const std::string&,
+                    std::vector<ReportServerLog>*) override {
+            return Call();
+        }
+
+        int GetAccountsByGroup(const std::string& group,
+                               std::vector<ReportAccountRecord>* accounts) override {
+            for (const auto& account : _accounts) {
+                if (MatchGroupMask(group, account.group)) {
+                    accounts->push_back(account);
+                }
+            }
+            return Call();
+        }
+
+        int GetAccountByLogin(int login, ReportAccountRecord* account) override {
+            const uint32_t position = _logins.Find(login);
+            if (position == LoginIndex::kNotFound) {
+                Call();
+                return RET_USER_NOT_FOUND;
+            }
+            *account = _accounts[position];
+            return Call();
+        }
+
+        int GetAccountBalanceByLogin(int login, ReportMarginLevel* margin) override {
+            const uint32_t position = _logins.Find(login);
+            if (position == LoginIndex::kNotFound) {
+                Call();
+                return RET_USER_NOT_FOUND;
+            }
+            *margin = _accounts[position].margin;
+            return Call();
+        }
+
+        int GetMarginLevelByGroup(const std::string& group,
+                                  std::vector<ReportMarginLevel>* margins) override {
+            for (const auto& account : _accounts) {
+                if (MatchGroupMask(group, account.group)) {
+                    margins->push_back(account.margin);
+                }
+            }
+            return Call();
+        }
+
+        int GetAccountsEquitiesByGroup(time_t, time_t, const std::string&,
+                                       std::vector<ReportEquityRecord>*) override {
+            return Call();
+        }
+
+        int GetAccountsEquitiesByLogin(time_t, time_t, int,
+                                       std::vector<ReportEquityRecord>*) override {
+            return Call();
+        }
+
+        int GetOpenTradesByLogin(int, std::vector<ReportTradeRecord>*) override { return Call(); }
+
+        int GetPendingTradesByLogin(int, std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int GetOpenTradesByMagic(int, std::vector<ReportTradeRecord>*) override { return Call(); }
+
+        int GetOpenTradeByOrder(int, ReportTradeRecord*) override { return Call(); }
+
+        int GetOpenTradeByGwUUID(const std::string&, ReportTradeRecord*) override { return Call(); }
+
+        int GetCloseTradeByGwUUID(const std::string&, ReportTradeRecord*) override {
+            return Call();
+        }
+
+        int GetOpenTradeByGwOrder(const std::string&, ReportTradeRecord*) override {
+            return Call();
+        }
+
+        int GetCloseTradeByGwOrder(const std::string&, ReportTradeRecord*) override {
+            return Call();
+        }
+
+        int GetCloseTradesByLogin(int, std::vector<ReportTradeRecord>*) override { return Call(); }
+
+        int GetCloseTradesByGroup(const std::string&, time_t, time_t,
+                                  std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int GetPendingTradesByGroup(const std::string&, time_t, time_t,
+                                    std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int GetOpenTradesByGroup(const std::string&, time_t, time_t,
+                                 std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int GetAllOpenTrades(std::vector<ReportTradeRecord>*) override { return Call(); }
+
+        int GetTransactionsByGroup(const std::string&, time_t, time_t,
+                                   std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int GetTransactionsByLogin(int, time_t, time_t, std::vector<ReportTradeRecord>*) override {
+            return Call();
+        }
+
+        int CalculateCommission(const ReportTradeRecord&, double*) override { return Call(); }
+
+        int CalculateSwap(const ReportTradeRecord&, double*) override { return Call(); }
+
+        int CalculateProfit(const ReportTradeRecord&, double*) override { return Call(); }
+
+        int CalculateMargin(const ReportTradeRecord&, double*) override { return Call(); }
+
+        int CalculateConvertRateByCurrency(const std::string& from_cur,
+                                           const std::string& to_cur,
+                                           int,
+                                           double* multiplier) override {
+            *multiplier =
+                from_cur == to_cur ? 1.0 : 1.0 + static_cast<double>(from_cur[0] % 7) / 10.0;
+            return Call();
+        }
+
+        int GetSymbol(const std::string&, ReportSymbolRecord*) override { return Call(); }
+
+        int MatchWildCardGroup(const std::string& mask, const std::string& group) override {
+            Call();
+            return MatchGroupMask(mask, group) ? RET_OK : RET_ERROR;
+        }
+
+        int GetGroup(const std::string& group_name, ReportGroupRecord* group) override {
+            for (const auto& record : _groups) {
+                if (record.group == group_name) {
+                    *group = record;
+                    return Call();
+                }
+            }
+            Call();
+            return RET_GROUP_NOT_FOUND;
+        }
+
+        int GetAllGroups(std::vector<ReportGroupRecord>* groups) override {
+            *groups = _groups;
+            return Call();
+        }
+
+        int GetCandles(const std::string&, const std::string&, time_t, time_t,
+                       std::vector<ReportCandleRecord>*) override {
+            return Call();
+        }
+
+    private:
+        std::vector<ReportAccountRecord> _accounts;
+        std::vector<ReportGroupRecord>   _groups;
+        LoginIndex                       _logins;
+
+        int Call() {
+            calls_count.fetch_add(1, std::memory_order_relaxed);
+            return RET_OK;
+        }
+
+        void Generate(const FakePopulation& population) {
+            static const char* kCurrencies[] = {
+                "USD", "EUR", "GBP", "JPY", "CHF", "AUD", "CAD", "NZD"};
+            const size_t currencies_count =
+                std::max<size_t>(1, std::min(population.currencies, std::size(kCurrencies)));
+
+            std::mt19937                           rng(population.seed);
+            std::uniform_real_distribution<double> money(100.0, 100000.0);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+            _groups.resize(std::max<size_t>(1, population.groups));
+            for (size_t i = 0; i < _groups.size(); ++i) {
+                ReportGroupRecord& group  = _groups[i];
+                const char*        prefix = i % 4 == 0 ? "demo\\group-" : "real\\group-";
+
+                group.grp_index      = static_cast<int>(i);
+                group.group          = prefix + std::to_string(i);
+                group.currency       = kCurrencies[i % currencies_count];
+                group.margin_call    = 100;
+                group.margin_stopout = 50;
+            }
+
+            _accounts.resize(population.accounts);
+            _logins.Reserve(population.accounts);
+
+            for (size_t i = 0; i < _accounts.size(); ++i) {
+                ReportAccountRecord&     account = _accounts[i];
+                const ReportGroupRecord& group   = _groups[i % _groups.size()];
+
+                account.login    = static_cast<int>(100000 + i);
+                account.group    = group.group;
+                account.name     = "Account holder " + std::to_string(account.login);
+                account.email    = "client" + std::to_string(account.login) + "@example.com";
+                account.country  = "Cyprus";
+                account.leverage = 100;
+                account.balance  = money(rng);
+
+                ReportMarginLevel& margin = account.margin;
+                margin.login              = account.login;
+                margin.group              = account.group;
+                margin.leverage           = account.leverage;
+                margin.balance            = account.balance;
+                margin.credit             = 0.0;
+                margin.margin             = account.balance * unit(rng);
+
+                const bool in_margin_call = unit(rng) < population.margin_call_fraction;
+
+                margin.equity       = in_margin_call ? margin.margin * (0.3 + 0.6 * unit(rng))
+                                                     : margin.margin * (1.5 + unit(rng));
+                margin.margin_free  = margin.equity - margin.margin;
+                margin.margin_level =
+                    margin.margin > 0 ? margin.equity / margin.margin * 100.0 : 0.0;
+
+                if (!in_margin_call) {
+                    margin.level_type = MARGINLEVEL_OK;
+                } else if (margin.margin_level < group.margin_stopout) {
+                    margin.level_type = MARGINLEVEL_STOPOUT;
+                } else {
+                    margin.level_type = MARGINLEVEL_MARGINCALL;
+                }
+
+                _logins.Insert(account.login, static_cast<uint32_t>(i));
+            }
+        }
+    };
+} // namespace bench
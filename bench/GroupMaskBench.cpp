@@ -0,0 +1,168 @@
+// Compiled GroupMask against MatchWildCardGroup of FakeReportServer (MatchGroupMask): checks
+// that both agree on random masks - comma lists, '*', '!' and spaces over a small alphabet, so
+// that patterns overlap - then times matching 300 group names against typical __access.groups
+// masks, including the Compile() cache lookup per request.
+//
+// FakeReportServer is this repository's model of the server, so the random check only covers
+// GroupMask against that model. --capture capture.bin checks GroupMask against the answers of
+// a real server instead: every MatchWildCardGroup record of a capture (MARGINCALL_CAPTURE_FILE,
+// the group validators call it per requested group) is replayed against GroupMask.
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "FakeReportServer.hpp"
+#include "capture/CaptureFormat.h"
+#include "structures/GroupMask.h"
+
+namespace {
+    constexpr size_t kRandomMasks  = 20000;
+    constexpr size_t kRandomGroups = 64;
+    constexpr int    kRepetitions  = 5;
+
+    std::string RandomString(std::mt19937& rng, const std::string& alphabet, const size_t max_size) {
+        std::uniform_int_distribution<size_t> size(0, max_size);
+        std::uniform_int_distribution<size_t> symbol(0, alphabet.size() - 1);
+
+        std::string value(size(rng), ' ');
+        for (char& c : value) {
+            c = alphabet[symbol(rng)];
+        }
+        return value;
+    }
+
+    // Число расхождений GroupMask с MatchGroupMask
+    size_t CheckEquivalence() {
+        std::mt19937 rng(11);
+
+        std::vector<std::string> groups;
+        for (size_t i = 0; i < kRandomGroups; ++i) {
+            groups.push_back(RandomString(rng, "ab\\", 6));
+        }
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < kRandomMasks; ++i) {
+            const std::string mask = RandomString(rng, "ab*!, \\", 10);
+            const GroupMask   compiled(mask);
+
+            for (const std::string& group : groups) {
+                if (compiled.Matches(group) != bench::MatchGroupMask(mask, group)) {
+                    if (++mismatches <= 10) {
+                        std::fprintf(stderr, "mismatch: mask '%s', group '%s'\n", mask.c_str(),
+                                     group.c_str());
+                    }
+                }
+            }
+        }
+        return mismatches;
+    }
+
+    // Записи MatchWildCardGroup из файла захвата: {проверено, расхождений}
+    std::pair<size_t, size_t> CheckCapture(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        const std::string data((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+
+        if (data.size() < 8 || data.compare(0, 4, capture::kMagic, 4) != 0) {
+            std::fprintf(stderr, "%s is not a capture file\n", path.c_str());
+            return {0, 1};
+        }
+
+        size_t checked    = 0;
+        size_t mismatches = 0;
+
+        capture::Reader reader(data.data() + 8, data.size() - 8);
+        while (!reader.AtEnd()) {
+            capture::CallId id{};
+            std::string     key;
+            uint64_t        latency_ns = 0;
+            int             code       = RET_OK;
+            std::string     error;
+            std::string     payload;
+            reader(id, key, latency_ns, code, error, payload);
+
+            if (id != capture::CallId::MatchWildCardGroup || !error.empty()) {
+                continue;
+            }
+
+            std::string     mask;
+            std::string     group;
+            capture::Reader key_reader(key.data(), key.size());
+            key_reader(mask, group);
+
+            ++checked;
+            const bool server_matched = code == RET_OK;
+            if (GroupMask(mask).Matches(group) != server_matched) {
+                if (++mismatches <= 10) {
+                    std::fprintf(stderr, "mismatch: mask '%s', group '%s', server: %d\n",
+                                 mask.c_str(), group.c_str(), server_matched);
+                }
+            }
+        }
+        return {checked, mismatches};
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--capture") {
+        const auto [checked, mismatches] = CheckCapture(argv[2]);
+        std::printf("GroupMask against captured MatchWildCardGroup: %zu answers, %zu mismatches\n",
+                    checked,
+                    mismatches);
+        // Запись без ответов MatchWildCardGroup ничего не проверяет
+        return checked > 0 && mismatches == 0 ? 0 : 1;
+    }
+
+    const size_t mismatches = CheckEquivalence();
+    std::printf("\n== GroupMask equivalence: %zu masks x %zu groups, %zu mismatches ==\n",
+                kRandomMasks,
+                kRandomGroups,
+                mismatches);
+
+    std::vector<std::string> groups;
+    for (size_t i = 0; i < 300; ++i) {
+        groups.push_back((i % 3 == 0 ? "demo\\group-" : "real\\group-") + std::to_string(i));
+    }
+
+    bench::FakePopulation   population;
+    bench::FakeReportServer server(population);
+
+    const std::vector<std::string> masks = {
+        "*",
+        "real\\*",
+        "real\\*,!real\\group-1*",
+        "demo\\group-3,demo\\group-6,real\\group-10,real\\group-200",
+        "*,!demo\\*,!*-99"};
+
+    bench::PrintHeader("group mask, 300 groups");
+    for (const std::string& mask : masks) {
+        const double server_ns = bench::BestOf(kRepetitions, [&] {
+            size_t matched = 0;
+            for (const std::string& group : groups) {
+                matched += server.MatchWildCardGroup(mask, group) == RET_OK;
+            }
+            bench::DoNotOptimize(matched);
+        });
+
+        const double compiled_ns = bench::BestOf(kRepetitions, [&] {
+            const std::shared_ptr<const GroupMask> compiled = GroupMask::Compile(mask);
+
+            size_t matched = 0;
+            for (const std::string& group : groups) {
+                matched += compiled->Matches(group);
+            }
+            bench::DoNotOptimize(matched);
+        });
+
+        std::printf("mask: %s\n", mask.c_str());
+        bench::PrintRow("  MatchWildCardGroup", groups.size(), server_ns);
+        bench::PrintRow("  GroupMask", groups.size(), compiled_ns);
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Build and lookup cost of LoginIndex against the std::unordered_map<int, ReportMarginLevel>
+// join previously used in CreateReport.
+
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "model/ReportAccount.hpp"
+#include "structures/LoginIndex.hpp"
+
+namespace {
+    constexpr int kRepetitions = 5;
+
+    std::vector<ReportMarginLevel> MakeMargins(const size_t count, std::mt19937& rng) {
+        std::vector<int> logins(count);
+        std::iota(logins.begin(), logins.end(), 100000);
+        std::shuffle(logins.begin(), logins.end(), rng);
+
+        std::vector<ReportMarginLevel> margins(count);
+        for (size_t i = 0; i < count; ++i) {
+            margins[i].login   = logins[i];
+            margins[i].group   = "real\\group-" + std::to_string(i % 300);
+            margins[i].balance = static_cast<double>(i);
+        }
+        return margins;
+    }
+
+    void Run(const size_t count) {
+        std::mt19937                   rng(42);
+        std::vector<ReportMarginLevel> margins = MakeMargins(count, rng);
+
+        // Half of the probes hit, half miss (accounts without a margin row)
+        std::vector<int> probes(count);
+        for (size_t i = 0; i < count; ++i) {
+            probes[i] = i % 2 == 0 ? margins[i].login : static_cast<int>(100000 + count + i);
+        }
+        std::shuffle(probes.begin(), probes.end(), rng);
+
+        const double map_build = bench::BestOf(kRepetitions, [&] {
+            std::unordered_map<int, ReportMarginLevel> margins_map;
+            for (const auto& margin_level : margins) {
+                margins_map[margin_level.login] = margin_level;
+            }
+            bench::DoNotOptimize(margins_map.size());
+        });
+
+        const double index_build = bench::BestOf(kRepetitions, [&] {
+            LoginIndex index(margins.size());
+            for (size_t i = 0; i < margins.size(); ++i) {
+                index.Insert(margins[i].login, static_cast<uint32_t>(i));
+            }
+            bench::DoNotOptimize(index.Size());
+        });
+
+        std::unordered_map<int, ReportMarginLevel> margins_map;
+        for (const auto& margin_level : margins) {
+            margins_map[margin_level.login] = margin_level;
+        }
+
+        LoginIndex index(margins.size());
+        for (size_t i = 0; i < margins.size(); ++i) {
+            index.Insert(margins[i].login, static_cast<uint32_t>(i));
+        }
+
+        const double map_lookup = bench::BestOf(kRepetitions, [&] {
+            double sum = 0.0;
+            for (const int login : probes) {
+                const auto it = margins_map.find(login);
+                if (it != margins_map.end()) {
+                    sum += it->second.balance;
+                }
+            }
+            bench::DoNotOptimize(sum);
+        });
+
+        const double index_lookup = bench::BestOf(kRepetitions, [&] {
+            double sum = 0.0;
+            for (const int login : probes) {
+                const uint32_t position = index.Find(login);
+                if (position != LoginIndex::kNotFound) {
+                    sum += margins[position].balance;
+                }
+            }
+            bench::DoNotOptimize(sum);
+        });
+
+        bench::PrintRow("unordered_map build", count, map_build);
+        bench::PrintRow("LoginIndex build", count, index_build);
+        bench::PrintRow("unordered_map lookup", probes.size(), map_lookup);
+        bench::PrintRow("LoginIndex lookup", probes.size(), index_lookup);
+    }
+} // namespace
+
+int main() {
+    bench::PrintHeader("login index");
+
+    for (const size_t count : {10000, 100000, 1000000}) {
+        Run(count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+// End-to-end CreateReport benchmark against FakeReportServer.
+//
+//   margincall_bench [--accounts 1000,10000,100000,1000000] [--groups 50] [--currencies 5]
+//                    [--fraction 0.01] [--repetitions 5] [--mask "*"] [--output result.json]
+//                    [--record capture.bin] [--replay capture.bin] [--replay-latency recorded]
+//                    [--snapshot-ttl-ms 0]
+//
+// Prints (or writes to --output) a JSON document with min/median timings of the whole
+// CreateReport call and of its stages, so runs of different commits can be diffed.
+// "plugin_stages" holds the averages of the plugin's own spans, read through StatsReport.
+//
+// --record appends every server response of the run to a capture file; --replay runs against
+// such a file (recorded on a fake or a production server) instead of FakeReportServer.
+// With --replay-latency recorded the replayed calls keep their recorded latencies.
+//
+// --snapshot-ttl-ms enables the plugin's SnapshotCache for the run (disabled by default, whatever
+// MARGINCALL_SNAPSHOT_TTL_MS says): repeated calls then measure the cache hit path.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "FakeReportServer.hpp"
+#include "capture/RecordingReportServer.h"
+#include "capture/ReplayReportServer.h"
+#include "PluginInterface.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    struct BenchConfig {
+        std::vector<size_t> accounts{1000, 10000, 100000, 1000000};
+        size_t              groups      = 50;
+        size_t              currencies  = 5;
+        double              fraction    = 0.01;
+        int                 repetitions = 5;
+        std::string         mask        = "*";
+        std::string         output;
+        std::string         record;
+        std::string         replay;
+        ReplayLatency       replay_latency = ReplayLatency::FullSpeed;
+        size_t              snapshot_ttl_ms = 0;
+    };
+
+    std::vector<size_t> ParseSizes(const std::string& value) {
+        std::vector<size_t> sizes;
+        std::stringstream   ss(value);
+        std::string         item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                sizes.push_back(std::strtoull(item.c_str(), nullptr, 10));
+            }
+        }
+        return sizes;
+    }
+
+    BenchConfig ParseArgs(const int argc, char** argv) {
+        BenchConfig config;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string name  = argv[i];
+            const std::string value = argv[i + 1];
+
+            if (name == "--accounts") {
+                config.accounts = ParseSizes(value);
+            } else if (name == "--groups") {
+                config.groups = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (name == "--currencies") {
+                config.currencies = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (name == "--fraction") {
+                config.fraction = std::strtod(value.c_str(), nullptr);
+            } else if (name == "--repetitions") {
+                config.repetitions = std::max(1, std::atoi(value.c_str()));
+            } else if (name == "--mask") {
+                config.mask = value;
+            } else if (name == "--output") {
+                config.output = value;
+            } else if (name == "--record") {
+                config.record = value;
+            } else if (name == "--replay") {
+                config.replay = value;
+            } else if (name == "--replay-latency") {
+                config.replay_latency =
+                    value == "recorded" ? ReplayLatency::Recorded : ReplayLatency::FullSpeed;
+            } else if (name == "--snapshot-ttl-ms") {
+                config.snapshot_ttl_ms = std::strtoull(value.c_str(), nullptr, 10);
+            } else {
+                std::cerr << "unknown option: " << name << std::endl;
+                std::exit(2);
+            }
+        }
+        return config;
+    }
+
+    // CreateReport пишет в std::cout на каждый вызов - на время замеров глушим
+    class QuietStdout {
+    public:
+        QuietStdout() : _buffer(std::cout.rdbuf(nullptr)) {}
+
+        ~QuietStdout() {
+            std::cout.rdbuf(_buffer);
+            std::cout.clear();
+        }
+
+    private:
+        std::streambuf* _buffer;
+    };
+
+    void AddTiming(Value& stages, const char* name, const bench::Timing& timing,
+                   Document::AllocatorType& allocator) {
+        Value stage(kObjectType);
+        stage.AddMember("min_ms", timing.min_ms, allocator);
+        stage.AddMember("median_ms", timing.median_ms, allocator);
+        stages.AddMember(StringRef(name), stage, allocator);
+    }
+
+    void ResetPluginStats() {
+        Document request;
+        request.SetObject();
+        request.AddMember("reset", true, request.GetAllocator());
+
+        Document response;
+        response.SetObject();
+        StatsReport(request, response, response.GetAllocator(), nullptr);
+    }
+
+    // Средние времена этапов по спанам самого плагина (StatsReport) за замер create_report
+    Value PluginStages(Document::AllocatorType& allocator) {
+        Document request;
+        request.SetObject();
+
+        Document response;
+        response.SetObject();
+        StatsReport(request, response, response.GetAllocator(), nullptr);
+
+        Value result(kObjectType);
+        for (const auto& stage : response["stages"].GetObject()) {
+            if (stage.value["count"].GetUint64() == 0) {
+                continue;
+            }
+
+            const uint64_t count = stage.value["count"].GetUint64();
+
+            Value timing(kObjectType);
+            timing.AddMember("avg_ms", stage.value["avg_ms"].GetDouble(), allocator);
+            timing.AddMember("max_ms", stage.value["max_ms"].GetDouble(), allocator);
+            timing.AddMember("rows", stage.value["rows"].GetUint64() / count, allocator);
+            timing.AddMember("bytes", stage.value["bytes"].GetUint64() / count, allocator);
+            result.AddMember(Value(stage.name, allocator), timing, allocator);
+        }
+        return result;
+    }
+
+    // calls_count - счётчик вызовов того сервера, который реально отвечает (fake или replay)
+    Value RunServer(const BenchConfig& config, ReportServerInterface& server,
+                    const std::atomic<size_t>& calls_count, Document::AllocatorType& allocator) {
+        Document request;
+        request.SetObject();
+        request.AddMember("group", Value(config.mask.c_str(), request.GetAllocator()),
+                          request.GetAllocator());
+        Value access(kObjectType);
+        access.AddMember("groups", "*", request.GetAllocator());
+        request.AddMember("__access", access, request.GetAllocator());
+
+        // Снимки предыдущего сервера (другой популяции) не должны попасть в замер
+        SnapshotCache::Instance().Clear();
+
+        size_t response_bytes = 0;
+        size_t calls_before   = 0;
+        size_t calls_per_run  = 0;
+        size_t rows           = 0;
+        size_t scanned        = 0;
+
+        Value stages(kObjectType);
+        Value plugin_stages(kObjectType);
+
+        {
+            QuietStdout quiet;
+
+            // Прогрев: executor, выбор плана по измеренной селективности
+            {
+                Document response;
+                response.SetObject();
+                CreateReport(request, response, response.GetAllocator(), &server);
+            }
+
+            calls_before = calls_count.load();
+            ResetPluginStats();
+
+            const bench::Timing create_report = bench::Sample(config.repetitions, [&] {
+                Document response;
+                response.SetObject();
+                CreateReport(request, response, response.GetAllocator(), &server);
+                bench::DoNotOptimize(response.MemberCount());
+            });
+            calls_per_run = (calls_count.load() - calls_before) / config.repetitions;
+            plugin_stages = PluginStages(allocator);
+
+            const bench::Timing fetch = bench::Sample(config.repetitions, [&] {
+                const FetchStageResult fetched = DataFetcher::Fetch(config.mask, &server, false);
+                bench::DoNotOptimize(fetched.margins.rows.size());
+            });
+
+            FetchStageResult fetched = DataFetcher::Fetch(config.mask, &server, false);
+
+            const bench::Timing plan = bench::Sample(config.repetitions, [&] {
+                const QueryPlanResult result =
+                    QueryPlanner::Execute(fetched.margins.rows, nullptr, config.mask, &server);
+                rows    = result.entries.size();
+                scanned = result.scanned_rows;
+            });
+
+            Document response;
+            response.SetObject();
+            CreateReport(request, response, response.GetAllocator(), &server);
+
+            const bench::Timing serialize = bench::Sample(config.repetitions, [&] {
+                StringBuffer         buffer;
+                Writer<StringBuffer> writer(buffer);
+                response.Accept(writer);
+                response_bytes = buffer.GetSize();
+            });
+
+            AddTiming(stages, "create_report", create_report, allocator);
+            AddTiming(stages, "fetch", fetch, allocator);
+            AddTiming(stages, "plan", plan, allocator);
+            AddTiming(stages, "serialize", serialize, allocator);
+        }
+
+        Value result(kObjectType);
+        result.AddMember("margin_rows", static_cast<uint64_t>(scanned), allocator);
+        result.AddMember("margin_call_rows", static_cast<uint64_t>(rows), allocator);
+        result.AddMember("response_bytes", static_cast<uint64_t>(response_bytes), allocator);
+        result.AddMember("server_calls", static_cast<uint64_t>(calls_per_run), allocator);
+        result.AddMember("stages", stages, allocator);
+        result.AddMember("plugin_stages", plugin_stages, allocator);
+        return result;
+    }
+
+    Value RunPopulation(const BenchConfig& config, const size_t accounts,
+                        Document::AllocatorType& allocator) {
+        bench::FakePopulation population;
+        population.accounts             = accounts;
+        population.groups               = config.groups;
+        population.currencies           = config.currencies;
+        population.margin_call_fraction = config.fraction;
+
+        bench::FakeReportServer server(population);
+
+        Value result;
+        if (config.record.empty()) {
+            result = RunServer(config, server, server.calls_count, allocator);
+        } else {
+            RecordingReportServer recorder(&server, config.record);
+            result = RunServer(config, recorder, server.calls_count, allocator);
+        }
+
+        result.AddMember("accounts", static_cast<uint64_t>(accounts), allocator);
+        return result;
+    }
+
+    Value RunReplay(const BenchConfig& config, Document::AllocatorType& allocator) {
+        ReplayReportServer server(config.replay, config.replay_latency);
+
+        Value result = RunServer(config, server, server.calls_count, allocator);
+        result.AddMember("capture", Value(config.replay.c_str(), allocator), allocator);
+        result.AddMember("capture_records", static_cast<uint64_t>(server.RecordsCount()),
+                         allocator);
+        return result;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const BenchConfig config = ParseArgs(argc, argv);
+
+    SnapshotCache::Instance().Configure(std::chrono::milliseconds(config.snapshot_ttl_ms),
+                                        SnapshotCache::kDefaultMaxBytes);
+
+    Document document;
+    document.SetObject();
+    auto& allocator = document.GetAllocator();
+
+    Value config_object(kObjectType);
+    config_object.AddMember("groups", static_cast<uint64_t>(config.groups), allocator);
+    config_object.AddMember("currencies", static_cast<uint64_t>(config.currencies), allocator);
+    config_object.AddMember("margin_call_fraction", config.fraction, allocator);
+    config_object.AddMember("repetitions", config.repetitions, allocator);
+    config_object.AddMember("mask", Value(config.mask.c_str(), allocator), allocator);
+    config_object.AddMember("snapshot_ttl_ms", static_cast<uint64_t>(config.snapshot_ttl_ms),
+                            allocator);
+
+    Value results(kArrayType);
+    if (!config.replay.empty()) {
+        std::cerr << "margincall_bench: replay " << config.replay << std::endl;
+        config_object.AddMember(
+            "replay_latency",
+            StringRef(config.replay_latency == ReplayLatency::Recorded ? "recorded" : "none"),
+            allocator);
+        results.PushBack(RunReplay(config, allocator), allocator);
+    } else {
+        for (const size_t accounts : config.accounts) {
+            std::cerr << "margincall_bench: " << accounts << " accounts" << std::endl;
+            results.PushBack(RunPopulation(config, accounts, allocator), allocator);
+        }
+    }
+
+    document.AddMember("benchmark", "margincall", allocator);
+    document.AddMember("config", config_object, allocator);
+    document.AddMember("results", results, allocator);
+
+    DestroyReport();
+
+    StringBuffer               buffer;
+    PrettyWriter<StringBuffer> writer(buffer);
+    document.Accept(writer);
+
+    if (config.output.empty()) {
+        std::cout << buffer.GetString() << std::endl;
+    } else {
+        std::ofstream(config.output) << buffer.GetString() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+// CreateReport over a 100k-account FakeReportServer with the full pull against the margin call
+// set maintained from events (EventReport). Applies a batch of balance events that move
+// accounts into and out of margin call, reports the cost per event and the size of the delta
+// response against the version before the events, then checks that the set holds exactly the
+// accounts a fresh pull selects, with the same margin levels.
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "BenchSupport.hpp"
+#include "FakeReportServer.hpp"
+#include "PluginInterface.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace {
+    constexpr size_t kAccountsCount = 100000;
+    constexpr size_t kEventsCount   = 2000;
+    constexpr int    kRepetitions   = 5;
+
+    // CreateReport пишет в std::cout на каждый вызов - на время замеров глушим
+    class QuietStdout {
+    public:
+        QuietStdout() : _buffer(std::cout.rdbuf(nullptr)) {}
+
+        ~QuietStdout() {
+            std::cout.rdbuf(_buffer);
+            std::cout.clear();
+        }
+
+    private:
+        std::streambuf* _buffer;
+    };
+
+    // Размер ответа в байтах JSON
+    size_t RunCreateReport(ReportServerInterface& server, const std::string& since_version = {}) {
+        Document request;
+        request.Parse(R"({"group": "*", "__access": {"groups": "*"}})");
+        if (!since_version.empty()) {
+            request.AddMember("since_version",
+                              Value(since_version.c_str(), request.GetAllocator()),
+                              request.GetAllocator());
+        }
+
+        Document response;
+        response.SetObject();
+        CreateReport(request, response, response.GetAllocator(), &server);
+
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        response.Accept(writer);
+        return buffer.GetSize();
+    }
+
+    void SendEvents(const std::vector<int>& logins, ReportServerInterface& server) {
+        Document request;
+        request.SetObject();
+        auto& allocator = request.GetAllocator();
+
+        Value events(kArrayType);
+        for (const int login : logins) {
+            Value event(kObjectType);
+            event.AddMember("type", static_cast<int>(EV_TYPE_BALANCE), allocator);
+            event.AddMember("record", static_cast<int>(EV_RECORD_UPDATE), allocator);
+            event.AddMember("login", login, allocator);
+            events.PushBack(event, allocator);
+        }
+        request.AddMember("events", events, allocator);
+
+        Document response;
+        response.SetObject();
+        EventReport(request, response, response.GetAllocator(), &server);
+    }
+
+    using Row = std::tuple<int, std::string, std::string, double, int>;
+
+    std::vector<Row> Rows(const std::vector<MarginCallEntry>& entries) {
+        std::vector<Row> rows;
+        rows.reserve(entries.size());
+        for (const auto& [margin, name] : entries) {
+            rows.emplace_back(margin.login, margin.group, name, margin.equity, margin.level_type);
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+} // namespace
+
+int main() {
+    bench::FakePopulation population;
+    population.accounts = kAccountsCount;
+
+    bench::FakeReportServer server(population);
+    QuietStdout             quiet;
+
+    // Полная выборка на каждый запрос (набор не активен)
+    RunCreateReport(server);
+    const bench::Timing pull =
+        bench::Sample(kRepetitions, [&] { RunCreateReport(server); });
+
+    // Активация набора и его заполнение первым CreateReport
+    SendEvents({}, server);
+    const bench::Timing seed = bench::Sample(1, [&] { RunCreateReport(server); });
+
+    const bench::Timing from_set =
+        bench::Sample(kRepetitions, [&] { RunCreateReport(server); });
+
+    // События: часть аккаунтов уходит в margin call, часть выходит из него
+    std::mt19937                          rng(7);
+    std::uniform_int_distribution<size_t> account(0, kAccountsCount - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    const std::string version_before =
+        MarginCallSet::Instance().VersionToken(MarginCallSet::Instance().Version());
+
+    std::vector<int> logins;
+    logins.reserve(kEventsCount);
+    for (size_t i = 0; i < kEventsCount; ++i) {
+        const ReportAccountRecord& record = server.Accounts()[account(rng)];
+        const double margin_level         = unit(rng) < 0.5 ? 40.0 + 50.0 * unit(rng)
+                                                            : 150.0 + 100.0 * unit(rng);
+        server.SetEquity(record.login, record.margin.margin * margin_level / 100.0);
+        logins.push_back(record.login);
+    }
+
+    const bench::Timing events = bench::Sample(1, [&] { SendEvents(logins, server); });
+
+    size_t full_bytes = 0;
+    const bench::Timing from_set_after =
+        bench::Sample(kRepetitions, [&] { full_bytes = RunCreateReport(server); });
+
+    size_t delta_bytes = 0;
+    const bench::Timing delta = bench::Sample(
+        kRepetitions, [&] { delta_bytes = RunCreateReport(server, version_before); });
+
+    // Проверка: набор совпадает со свежей выборкой
+    MarginCallSelection selection;
+    MarginCallSet::Instance().Select("*", &server, selection);
+    const std::vector<MarginCallEntry>& set_entries = selection.entries;
+
+    std::vector<ReportMarginLevel> margins;
+    server.GetMarginLevelByGroup("*", &margins);
+    const QueryPlanResult pulled =
+        QueryPlanner::Execute(std::move(margins), nullptr, "*", &server);
+
+    const bool matches = Rows(set_entries) == Rows(pulled.entries);
+
+    DestroyReport();
+
+    std::printf("\n== margin call set, %zu accounts, %zu rows ==\n",
+                kAccountsCount,
+                set_entries.size());
+    std::printf("%-28s %14s %12s\n", "case", "min, ms", "median, ms");
+    std::printf("%-28s %14.3f %12.3f\n", "CreateReport, full pull", pull.min_ms, pull.median_ms);
+    std::printf("%-28s %14.3f %12.3f\n", "CreateReport, seeding", seed.min_ms, seed.median_ms);
+    std::printf("%-28s %14.3f %12.3f\n", "CreateReport, from set", from_set.min_ms,
+                from_set.median_ms);
+    std::printf("%-28s %14.3f %12.3f\n", "  after events", from_set_after.min_ms,
+                from_set_after.median_ms);
+    std::printf("%-28s %14.3f %12.3f\n", "  delta since events", delta.min_ms,
+                delta.median_ms);
+    std::printf("%-28s %14.3f %12.2f us/event\n", "EventReport, balance events", events.min_ms,
+                events.min_ms * 1000.0 / static_cast<double>(kEventsCount));
+    std::printf("response bytes: full %zu, delta %zu (%.1f%%)\n",
+                full_bytes,
+                delta_bytes,
+                100.0 * static_cast<double>(delta_bytes) / static_cast<double>(full_bytes));
+
+    if (!matches) {
+        std::fprintf(stderr, "margin call set differs from a fresh pull\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,389 @@
+// Margin call table of 50k rows built through the ast path (TableBuilder::AddRow ->
+// CreateTableProps -> ast::Node -> to_json) and through the consuming ast path (rvalue AddRow,
+// std::move(builder).CreateTableProps(), to_json(Node&&)).
+// Checks that both produce byte-identical JSON, that the consuming path allocates every
+// name cell string at most once, and reports wall time and heap allocations of each path.
+// The typed path of CreateReport (AppendRow into typed columns -> WriteTableProps, and
+// StreamTableProps for __accept_serialized) is checked byte for byte against the same ast output
+// and timed next to it.
+// Then compares the cost of a JSON string: Document + Writer against the SAX writers
+// (ast::write_json over the Node tree, TableBuilder::StreamTableProps from the columns).
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.hpp"
+#include "BenchSupport.hpp"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "structures/ReportStructures.hpp"
+#include "utils/Utils.h"
+
+namespace {
+    constexpr size_t kRowsCount   = 50000;
+    constexpr int    kRepetitions = 5;
+
+    // Имена фиксированной длины: по числу аллокаций такого размера видно копии строк ячеек
+    constexpr size_t kNameLength = 40;
+
+    std::vector<MarginCallEntry> MakeEntries(const size_t count) {
+        std::vector<MarginCallEntry> entries(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto& [margin_level, name] = entries[i];
+            margin_level.login         = static_cast<int>(100000 + i);
+            margin_level.leverage      = 100;
+            margin_level.balance       = 1000.0 + static_cast<double>(i) * 0.37;
+            margin_level.credit        = static_cast<double>(i % 50);
+            margin_level.equity        = margin_level.balance * 0.4;
+            margin_level.margin        = margin_level.balance * 0.6;
+            margin_level.margin_free   = margin_level.equity - margin_level.margin;
+            margin_level.margin_level  = 66.666;
+            name.resize(kNameLength + 1);
+            std::snprintf(name.data(), name.size(), "Account holder name #%019zu", i);
+            name.resize(kNameLength);
+        }
+        return entries;
+    }
+
+    // typed - колонки с типами, как в CreateReport; иначе ColumnType::Value для AddRow
+    void ConfigureTable(TableBuilder& table_builder, const bool typed = false) {
+        FilterConfig search_filter;
+        search_filter.type = FilterType::Search;
+
+        const auto type = [typed](const ColumnType column_type) {
+            return typed ? column_type : ColumnType::Value;
+        };
+
+        table_builder.SetIdColumn("login");
+        table_builder.SetOrderBy("login", "DESC");
+        table_builder.EnableTotal(true);
+        table_builder.SetTotalDataTitle("TOTAL");
+
+        table_builder.AddColumn({"login", "LOGIN", 1, search_filter}, type(ColumnType::Int64));
+        table_builder.AddColumn({"name", "NAME", 2, search_filter}, type(ColumnType::String));
+        table_builder.AddColumn({"leverage", "LEVERAGE", 3, search_filter},
+                                type(ColumnType::Int64));
+        table_builder.AddColumn({"balance", "BALANCE", 4, search_filter},
+                                type(ColumnType::Decimal));
+        table_builder.AddColumn({"credit", "CREDIT", 5, search_filter}, type(ColumnType::Decimal));
+        table_builder.AddColumn({"floating_pl", "Floating P/L", 6, search_filter},
+                                type(ColumnType::Decimal));
+        table_builder.AddColumn({"equity", "EQUITY", 7, search_filter}, type(ColumnType::Decimal));
+        table_builder.AddColumn({"margin", "MARGIN", 8, search_filter}, type(ColumnType::Decimal));
+        table_builder.AddColumn({"margin_free", "MARGIN_FREE", 9, search_filter},
+                                type(ColumnType::Decimal));
+        table_builder.AddColumn({"margin_level", "MARGIN_LEVEL", 10, search_filter},
+                                type(ColumnType::Decimal));
+        table_builder.AddColumn({"currency", "CURRENCY", 11, search_filter},
+                                type(ColumnType::Dictionary));
+    }
+
+    void BuildWithAst(const std::vector<MarginCallEntry>& entries, Document& document) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder);
+
+        const std::string currency = "USD";
+        for (const auto& [margin_level, name] : entries) {
+            const double floating_pl = margin_level.equity - margin_level.balance;
+            table_builder.AddRow({static_cast<int64_t>(margin_level.login),
+                                  name,
+                                  static_cast<int64_t>(margin_level.leverage),
+                                  utils::TruncateDouble(margin_level.balance, 2),
+                                  utils::TruncateDouble(margin_level.credit, 2),
+                                  utils::TruncateDouble(floating_pl, 2),
+                                  utils::TruncateDouble(margin_level.equity, 2),
+                                  utils::TruncateDouble(margin_level.margin, 2),
+                                  utils::TruncateDouble(margin_level.margin_free, 2),
+                                  utils::TruncateDouble(margin_level.margin_level, 2),
+                                  currency});
+        }
+
+        const JSONObject table_props = table_builder.CreateTableProps();
+        const Node       table_node  = Table({}, table_props);
+        const Node       report = Column({h1({text("Margin Call Report")}), table_node});
+
+        document.SetObject();
+        utils::CreateUI(report, document, document.GetAllocator());
+    }
+
+    void BuildWithAstConsuming(const std::vector<MarginCallEntry>& entries, Document& document) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder);
+
+        const std::string currency = "USD";
+        for (const auto& [margin_level, name] : entries) {
+            const double floating_pl = margin_level.equity - margin_level.balance;
+
+            // Не initializer_list: его элементы константные и копировались бы еще раз
+            std::vector<JSONValue> row;
+            row.reserve(11);
+            row.emplace_back(static_cast<int64_t>(margin_level.login));
+            row.emplace_back(name);
+            row.emplace_back(static_cast<int64_t>(margin_level.leverage));
+            row.emplace_back(utils::TruncateDouble(margin_level.balance, 2));
+            row.emplace_back(utils::TruncateDouble(margin_level.credit, 2));
+            row.emplace_back(utils::TruncateDouble(floating_pl, 2));
+            row.emplace_back(utils::TruncateDouble(margin_level.equity, 2));
+            row.emplace_back(utils::TruncateDouble(margin_level.margin, 2));
+            row.emplace_back(utils::TruncateDouble(margin_level.margin_free, 2));
+            row.emplace_back(utils::TruncateDouble(margin_level.margin_level, 2));
+            row.emplace_back(currency);
+            table_builder.AddRow(std::move(row));
+        }
+
+        NodeList children;
+        children.push_back(h1({text("Margin Call Report")}));
+        children.push_back(Table({}, std::move(table_builder).CreateTableProps()));
+
+        document.SetObject();
+        utils::CreateUI(Column(std::move(children)), document, document.GetAllocator());
+    }
+
+    // Строки, добавленные в TableBuilder, как в BuildWithAst
+    void FillTable(const std::vector<MarginCallEntry>& entries, TableBuilder& table_builder) {
+        const std::string currency = "USD";
+        for (const auto& [margin_level, name] : entries) {
+            const double floating_pl = margin_level.equity - margin_level.balance;
+            table_builder.AddRow({static_cast<int64_t>(margin_level.login),
+                                  name,
+                                  static_cast<int64_t>(margin_level.leverage),
+                                  utils::TruncateDouble(margin_level.balance, 2),
+                                  utils::TruncateDouble(margin_level.credit, 2),
+                                  utils::TruncateDouble(floating_pl, 2),
+                                  utils::TruncateDouble(margin_level.equity, 2),
+                                  utils::TruncateDouble(margin_level.margin, 2),
+                                  utils::TruncateDouble(margin_level.margin_free, 2),
+                                  utils::TruncateDouble(margin_level.margin_level, 2),
+                                  currency});
+        }
+    }
+
+    // {"ui": ...} без Document: дерево ast::Node пишется в Writer SAX-событиями
+    std::string SerializeWithAstWriter(const std::vector<MarginCallEntry>& entries) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder);
+        FillTable(entries, table_builder);
+
+        const Node report =
+            Column({h1({text("Margin Call Report")}), Table({}, table_builder.CreateTableProps())});
+
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("ui");
+        utils::WriteUI(writer, [&](auto& handler) { return write_json(report, handler); });
+        writer.EndObject();
+        return buffer.GetString();
+    }
+
+    // То же, но props таблицы пишутся прямо из колонок TableBuilder
+    std::string SerializeWithTableStream(const std::vector<MarginCallEntry>& entries) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder);
+        FillTable(entries, table_builder);
+
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("ui");
+        utils::WriteUI(writer, [&](auto& handler) {
+            return handler.StartObject() &&
+                   handler.Key("type") && handler.String("Column") &&
+                   handler.Key("children") && handler.StartArray() &&
+                   write_json(h1({text("Margin Call Report")}), handler) &&
+                   handler.StartObject() &&
+                   handler.Key("type") && handler.String("Table") &&
+                   handler.Key("props") && table_builder.StreamTableProps(handler) &&
+                   handler.EndObject() &&
+                   handler.EndArray() &&
+                   handler.EndObject();
+        });
+        writer.EndObject();
+        return buffer.GetString();
+    }
+
+    // Типизированные колонки, как в CreateReport: Decimal-ячейки, код словаря валюты
+    void FillTypedTable(const std::vector<MarginCallEntry>& entries, TableBuilder& table_builder) {
+        const std::string currency = "USD";
+        table_builder.SetDictionary("currency", {currency});
+        table_builder.ReserveRows(entries.size());
+
+        for (const auto& [margin_level, name] : entries) {
+            const double floating_pl = margin_level.equity - margin_level.balance;
+            table_builder.AppendRow(margin_level.login,
+                                    name,
+                                    margin_level.leverage,
+                                    Decimal::Truncate(margin_level.balance, 2),
+                                    Decimal::Truncate(margin_level.credit, 2),
+                                    Decimal::Truncate(floating_pl, 2),
+                                    Decimal::Truncate(margin_level.equity, 2),
+                                    Decimal::Truncate(margin_level.margin, 2),
+                                    Decimal::Truncate(margin_level.margin_free, 2),
+                                    Decimal::Truncate(margin_level.margin_level, 2),
+                                    DictionaryCode{0});
+        }
+    }
+
+    // DOM-путь CreateReport: WriteTableProps пишет строки из колонок прямо в rapidjson
+    void BuildWithTypedColumns(const std::vector<MarginCallEntry>& entries, Document& document) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder, true);
+        FillTypedTable(entries, table_builder);
+
+        document.SetObject();
+        Document::AllocatorType& allocator = document.GetAllocator();
+
+        Value table_props(kObjectType);
+        table_builder.WriteTableProps(table_props, allocator);
+
+        Value table_object(kObjectType);
+        table_object.AddMember("type", "Table", allocator);
+        table_object.AddMember("props", table_props, allocator);
+
+        Value report_object;
+        to_json(Column({h1({text("Margin Call Report")})}), report_object, allocator);
+        report_object["children"].PushBack(table_object, allocator);
+
+        utils::CreateUI(report_object, document, allocator);
+    }
+
+    // SAX-путь CreateReport (__accept_serialized) из тех же типизированных колонок
+    std::string SerializeWithTypedStream(const std::vector<MarginCallEntry>& entries) {
+        TableBuilder table_builder("MarginCallReportTable");
+        ConfigureTable(table_builder, true);
+        FillTypedTable(entries, table_builder);
+
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("ui");
+        utils::WriteUI(writer, [&](auto& handler) {
+            return handler.StartObject() &&
+                   handler.Key("type") && handler.String("Column") &&
+                   handler.Key("children") && handler.StartArray() &&
+                   write_json(h1({text("Margin Call Report")}), handler) &&
+                   handler.StartObject() &&
+                   handler.Key("type") && handler.String("Table") &&
+                   handler.Key("props") && table_builder.StreamTableProps(handler) &&
+                   handler.EndObject() &&
+                   handler.EndArray() &&
+                   handler.EndObject();
+        });
+        writer.EndObject();
+        return buffer.GetString();
+    }
+
+    std::string Serialize(const Document& document) {
+        StringBuffer         buffer;
+        Writer<StringBuffer> writer(buffer);
+        document.Accept(writer);
+        return buffer.GetString();
+    }
+
+    // Возвращает число аллокаций строк имен (kNameLength + 1 байт) за одну сборку
+    template <typename Build>
+    size_t Measure(const char* name, const std::vector<MarginCallEntry>& entries, Build build) {
+        const size_t            names_before = bench::AllocationsOfSize(kNameLength + 1);
+        const bench::AllocStats start        = bench::AllocationsSnapshot();
+        {
+            Document document;
+            build(entries, document);
+        }
+        const bench::AllocStats allocations = bench::AllocationsSince(start);
+        const size_t name_allocations = bench::AllocationsOfSize(kNameLength + 1) - names_before;
+
+        const double elapsed = bench::BestOf(kRepetitions, [&] {
+            Document document;
+            build(entries, document);
+            bench::DoNotOptimize(document.MemberCount());
+        });
+
+        bench::PrintRow(name, entries.size(), elapsed);
+        std::printf("%-28s %10zu allocations, %zu bytes, %zu name cell strings\n",
+                    "",
+                    allocations.count,
+                    allocations.bytes,
+                    name_allocations);
+
+        return name_allocations;
+    }
+} // namespace
+
+int main() {
+    const std::vector<MarginCallEntry> entries = MakeEntries(kRowsCount);
+
+    Document ast_document;
+    BuildWithAst(entries, ast_document);
+
+    Document consuming_document;
+    BuildWithAstConsuming(entries, consuming_document);
+
+    const std::string ast_json       = Serialize(ast_document);
+    const std::string consuming_json = Serialize(consuming_document);
+
+    if (ast_json != consuming_json) {
+        std::fprintf(stderr, "consuming ast output differs from the ast path\n");
+        return 1;
+    }
+
+    bench::PrintHeader("ast table, " + std::to_string(ast_json.size()) + " bytes of JSON");
+    Measure("ast::Node path", entries, BuildWithAst);
+    const size_t consuming_names = Measure("ast::Node consuming", entries, BuildWithAstConsuming);
+
+    if (consuming_names > entries.size()) {
+        std::fprintf(stderr, "consuming ast path allocated %zu name strings for %zu rows\n",
+                     consuming_names, entries.size());
+        return 1;
+    }
+
+    Document typed_document;
+    BuildWithTypedColumns(entries, typed_document);
+
+    if (Serialize(typed_document) != ast_json) {
+        std::fprintf(stderr, "typed WriteTableProps output differs from the ast path\n");
+        return 1;
+    }
+
+    Measure("typed WriteTableProps", entries, BuildWithTypedColumns);
+
+    if (SerializeWithAstWriter(entries) != ast_json) {
+        std::fprintf(stderr, "ast::write_json output differs from the Document path\n");
+        return 1;
+    }
+
+    if (SerializeWithTableStream(entries) != ast_json) {
+        std::fprintf(stderr, "StreamTableProps output differs from the Document path\n");
+        return 1;
+    }
+
+    if (SerializeWithTypedStream(entries) != ast_json) {
+        std::fprintf(stderr, "typed StreamTableProps output differs from the Document path\n");
+        return 1;
+    }
+
+    bench::PrintHeader("JSON string, " + std::to_string(ast_json.size()) + " bytes");
+    bench::PrintRow("Document + Writer", entries.size(), bench::BestOf(kRepetitions, [&] {
+        Document document;
+        BuildWithAst(entries, document);
+        bench::DoNotOptimize(Serialize(document).size());
+    }));
+    bench::PrintRow("ast::write_json", entries.size(), bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(SerializeWithAstWriter(entries).size());
+    }));
+    bench::PrintRow("StreamTableProps", entries.size(), bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(SerializeWithTableStream(entries).size());
+    }));
+    bench::PrintRow("typed Document + Writer", entries.size(), bench::BestOf(kRepetitions, [&] {
+        Document document;
+        BuildWithTypedColumns(entries, document);
+        bench::DoNotOptimize(Serialize(document).size());
+    }));
+    bench::PrintRow("typed StreamTableProps", entries.size(), bench::BestOf(kRepetitions, [&] {
+        bench::DoNotOptimize(SerializeWithTypedStream(entries).size());
+    }));
+
+    return 0;
+}
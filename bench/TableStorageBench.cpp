@@ -0,0 +1,111 @@
+// Memory and build time of 100k margin call rows kept in TableBuilder: untyped
+// ColumnType::Value columns filled through AddRow (one JSONValue per cell, as before the
+// columnar storage) against typed columns filled through AppendRow.
+
+#include <string>
+#include <vector>
+
+#include "AllocCounter.hpp"
+#include "BenchSupport.hpp"
+#include "rapidjson/document.h"
+#include "sbxTableBuilder/SBXTableBuilder.hpp"
+
+namespace {
+    constexpr size_t kRowsCount = 100000;
+
+    const char* kCurrencies[] = {"USD", "EUR", "GBP", "JPY", "CHF"};
+
+    void AddColumns(TableBuilder& table_builder, const bool typed) {
+        // Колонки без фильтра; filter указан явно ради -Wmissing-field-initializers
+        const auto add = [&](const char* key, const char* title, const double order,
+                             const ColumnType column_type) {
+            table_builder.AddColumn({key, title, order, std::nullopt},
+                                    typed ? column_type : ColumnType::Value);
+        };
+
+        add("login", "LOGIN", 1, ColumnType::Int64);
+        add("name", "NAME", 2, ColumnType::String);
+        add("leverage", "LEVERAGE", 3, ColumnType::Int64);
+        add("balance", "BALANCE", 4, ColumnType::Double);
+        add("credit", "CREDIT", 5, ColumnType::Double);
+        add("floating_pl", "Floating P/L", 6, ColumnType::Double);
+        add("equity", "EQUITY", 7, ColumnType::Double);
+        add("margin", "MARGIN", 8, ColumnType::Double);
+        add("margin_free", "MARGIN_FREE", 9, ColumnType::Double);
+        add("margin_level", "MARGIN_LEVEL", 10, ColumnType::Double);
+        add("currency", "CURRENCY", 11, ColumnType::String);
+    }
+
+    // Имена повторяются: у крупных брокеров много однотипных аккаунтов (IB, MAM, счета-дубли)
+    std::string NameOf(const size_t row) {
+        return "Account holder name #" + std::to_string(row % 20000);
+    }
+
+    void FillWithAddRow(TableBuilder& table_builder) {
+        for (size_t row = 0; row < kRowsCount; ++row) {
+            const double balance = 1000.0 + static_cast<double>(row) * 0.37;
+            table_builder.AddRow({static_cast<double>(100000 + row),
+                                  NameOf(row),
+                                  100.0,
+                                  balance,
+                                  0.0,
+                                  -balance * 0.6,
+                                  balance * 0.4,
+                                  balance * 0.6,
+                                  -balance * 0.2,
+                                  66.66,
+                                  kCurrencies[row % 5]});
+        }
+    }
+
+    void FillWithAppendRow(TableBuilder& table_builder) {
+        table_builder.ReserveRows(kRowsCount);
+
+        for (size_t row = 0; row < kRowsCount; ++row) {
+            const double balance = 1000.0 + static_cast<double>(row) * 0.37;
+            table_builder.AppendRow(static_cast<int>(100000 + row),
+                                    NameOf(row),
+                                    100,
+                                    balance,
+                                    0.0,
+                                    -balance * 0.6,
+                                    balance * 0.4,
+                                    balance * 0.6,
+                                    -balance * 0.2,
+                                    66.66,
+                                    kCurrencies[row % 5]);
+        }
+    }
+
+    template <typename Fill>
+    void Measure(const char* name, const bool typed, Fill fill) {
+        const size_t heap_before = bench::LiveHeapBytes();
+        size_t       heap_rows   = 0;
+
+        const double elapsed = bench::BestOf(3, [&] {
+            TableBuilder table_builder("MarginCallReportTable");
+            AddColumns(table_builder, typed);
+            fill(table_builder);
+            heap_rows = bench::LiveHeapBytes() - heap_before;
+
+            Document document;
+            Value    props(kObjectType);
+            table_builder.WriteTableProps(props, document.GetAllocator());
+            bench::DoNotOptimize(props.MemberCount());
+        });
+
+        bench::PrintRow(name, kRowsCount, elapsed);
+        std::printf("%-28s %10s %.1f MB held by rows, %.1f bytes/row\n",
+                    "",
+                    "",
+                    static_cast<double>(heap_rows) / (1024.0 * 1024.0),
+                    static_cast<double>(heap_rows) / static_cast<double>(kRowsCount));
+    }
+} // namespace
+
+int main() {
+    bench::PrintHeader("table storage, build + WriteTableProps");
+    Measure("AddRow, JSONValue cells", false, FillWithAddRow);
+    Measure("AppendRow, typed columns", true, FillWithAppendRow);
+    return 0;
+}
@@ -9,11 +9,25 @@
 #include <iomanip>
 #include <unordered_map>
 #include <iostream>
+#include <memory>
+#include <cstring>
 
 #include "rapidjson/document.h"
 #include "ReportServerInterface.h"
 #include "ast/Ast.hpp"
 #include "sbxTableBuilder/SBXTableBuilder.hpp"
+#include "caches/RateCache.h"
+#include "caches/SnapshotCache.h"
+#include "caches/ValidationCache.h"
+#include "capture/RecordingReportServer.h"
+#include "encoding/CborWriter.h"
+#include "events/MarginCallSet.h"
+#include "executors/Executor.h"
+#include "fetchers/DataFetcher.h"
+#include "metrics/ReportMetrics.h"
+#include "paging/Paginator.h"
+#include "planners/QueryPlanner.h"
+#include "structures/GroupIndex.h"
 #include "structures/ReportStructures.hpp"
 #include "structures/ReportType.h"
 #include "structures/ValidationResult.h"
@@ -30,6 +44,20 @@ extern "C" {
                      rapidjson::Document::AllocatorType& allocator,
                      ReportServerInterface* server);
 
+    // Накопленные с загрузки плагина тайминги этапов CreateReport и счетчики кэша снимков;
+    // {"reset": true} обнуляет их
+    void StatsReport(rapidjson::Value& request,
+                     rapidjson::Value& response,
+                     rapidjson::Document::AllocatorType& allocator,
+                     ReportServerInterface* server);
+
+    // События сервера (баланс, трейды, аккаунты, группы) для набора margin call, который
+    // CreateReport читает вместо полной выборки: {"events": [{"type", "record", "login"}]}
+    void EventReport(rapidjson::Value& request,
+                     rapidjson::Value& response,
+                     rapidjson::Document::AllocatorType& allocator,
+                     ReportServerInterface* server);
+
     void DestroyReport();
 
     void CreateReport(rapidjson::Value& request,
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ast {
+
+    // ====================== Arena ======================
+
+    namespace detail {
+        inline std::pmr::memory_resource*& CurrentResourceSlot() {
+            thread_local std::pmr::memory_resource* resource = nullptr;
+            return resource;
+        }
+    } // namespace detail
+
+    // Арена ScopedArena, из которой строятся ast-контейнеры в текущем потоке; nullptr - куча
+    inline std::pmr::memory_resource* CurrentResource() {
+        return detail::CurrentResourceSlot();
+    }
+
+    /**
+     * Allocator of ast strings, arrays, objects and child lists. A default-constructed allocator
+     * (and so every new container) takes CurrentResource(); copies of a container take the
+     * resource current at the point of the copy, not the source's. Move construction of a
+     * container carries the resource along, so returning a subtree never copies it. Move
+     * assignment and swap keep the target's resource, and elements are built with uses-allocator
+     * construction (JSONValue, JSONObject and Node take the container's allocator): a long-lived
+     * container assigned or filled from an arena tree copies the elements, at every level,
+     * instead of adopting memory that dies with the arena.
+     *
+     * std::pmr::polymorphic_allocator is not used directly because its default is the
+     * process-wide default resource, while the arena here is per thread (per request). Without
+     * an arena the allocator goes straight to std::allocator: new_delete_resource() would take
+     * the aligned operator new path for every string.
+     */
+    template <typename T>
+    class ArenaAllocator {
+    public:
+        using value_type                             = T;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap            = std::false_type;
+
+        ArenaAllocator() noexcept : _resource(CurrentResource()) {}
+        ArenaAllocator(std::pmr::memory_resource* resource) noexcept : _resource(resource) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _resource(other.resource()) {}
+
+        [[nodiscard]] T* allocate(const size_t n) {
+            if (_resource == nullptr) {
+                return std::allocator<T>().allocate(n);
+            }
+            return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, const size_t n) noexcept {
+            if (_resource == nullptr) {
+                std::allocator<T>().deallocate(p, n);
+            } else {
+                _resource->deallocate(p, n * sizeof(T), alignof(T));
+            }
+        }
+
+        // Элемент получает ресурс контейнера, если умеет его принять (allocator_type)
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args) {
+            std::uninitialized_construct_using_allocator(p, *this, std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] ArenaAllocator select_on_container_copy_construction() const { return {}; }
+
+        [[nodiscard]] std::pmr::memory_resource* resource() const noexcept { return _resource; }
+
+        friend bool operator==(const ArenaAllocator& lhs, const ArenaAllocator& rhs) noexcept {
+            return lhs._resource == rhs._resource ||
+                   (lhs._resource != nullptr && rhs._resource != nullptr &&
+                    lhs._resource->is_equal(*rhs._resource));
+        }
+
+    private:
+        std::pmr::memory_resource* _resource;
+    };
+
+    namespace detail {
+        struct RetainedArenaBuffer;
+
+        // Буферы арен всех потоков и их предел: ScopedArena::ReleaseRetained освобождает их разом
+        struct ArenaBufferRegistry {
+            std::mutex                        mutex;
+            std::vector<RetainedArenaBuffer*> buffers;
+            std::atomic<size_t>               max_retained_size{1024 * 1024};
+        };
+
+        inline ArenaBufferRegistry& ArenaBuffers() {
+            // Не разрушается: потоки хоста могут завершаться после статиков
+            static auto* registry = new ArenaBufferRegistry;
+            return *registry;
+        }
+
+        // Буфер арены, оставляемый потоку между запросами (см. ScopedArena). data и size меняет
+        // только поток-владелец, пока in_use, или ReleaseRetained под mutex реестра
+        struct RetainedArenaBuffer {
+            std::unique_ptr<std::byte[]> data;
+            size_t                       size   = 0;
+            bool                         in_use = false;
+
+            RetainedArenaBuffer() {
+                ArenaBufferRegistry&        registry = ArenaBuffers();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.buffers.push_back(this);
+            }
+
+            ~RetainedArenaBuffer() {
+                ArenaBufferRegistry&        registry = ArenaBuffers();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                std::erase(registry.buffers, this);
+            }
+
+            RetainedArenaBuffer(const RetainedArenaBuffer&)            = delete;
+            RetainedArenaBuffer& operator=(const RetainedArenaBuffer&) = delete;
+        };
+
+        inline RetainedArenaBuffer& ThreadArenaBuffer() {
+            thread_local RetainedArenaBuffer buffer;
+            return buffer;
+        }
+
+        // Upstream арены: считает, сколько она взяла сверх начального буфера
+        class CountingResource final : public std::pmr::memory_resource {
+        public:
+            [[nodiscard]] size_t allocated() const { return _allocated; }
+
+        private:
+            size_t _allocated = 0;
+
+            void* do_allocate(const size_t bytes, const size_t alignment) override {
+                _allocated += bytes;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void* p, const size_t bytes, const size_t alignment) override {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+
+            [[nodiscard]] bool do_is_equal(
+                const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * Per-request arena: while alive, every ast container created on this thread allocates from
+     * one std::pmr::monotonic_buffer_resource; the destructor drops all of it at once and
+     * restores the previous resource. Frees inside the arena are no-ops.
+     *
+     * The first buffer of the arena is kept by the thread between requests and grows to the
+     * largest request seen, up to MaxRetainedSize() (1 MB by default), so a steady stream of
+     * similar reports touches the same warm memory instead of fresh pages from malloc every
+     * time. Larger requests take the rest from malloc and give it back at the end. A nested
+     * arena on the same thread starts without it. ReleaseRetained() frees the idle buffers of
+     * all threads (the plugin calls it on unload).
+     *
+     * Everything built under the arena must be destroyed before it - declare the ScopedArena
+     * first in the scope. Data that outlives the request (caches, statics) is built under
+     * HeapScope.
+     */
+    class ScopedArena {
+    public:
+        static constexpr size_t kInitialSize = 64 * 1024;
+
+        [[nodiscard]] static size_t MaxRetainedSize() {
+            return detail::ArenaBuffers().max_retained_size.load(std::memory_order_relaxed);
+        }
+
+        // Буферы больше нового предела сбрасываются в конце следующего запроса потока
+        static void SetMaxRetainedSize(const size_t size) {
+            detail::ArenaBuffers().max_retained_size.store(size, std::memory_order_relaxed);
+        }
+
+        // Освобождает буферы потоков, которые сейчас не строят запрос
+        static void ReleaseRetained() {
+            detail::ArenaBufferRegistry& registry = detail::ArenaBuffers();
+            std::lock_guard<std::mutex>  lock(registry.mutex);
+            for (detail::RetainedArenaBuffer* buffer : registry.buffers) {
+                if (!buffer->in_use) {
+                    buffer->data.reset();
+                    buffer->size = 0;
+                }
+            }
+        }
+
+        ScopedArena()
+            : _buffer(AcquireBuffer()),
+              _resource(_buffer != nullptr ? _buffer->data.get() : nullptr,
+                        _buffer != nullptr ? _buffer->size : 0,
+                        &_upstream),
+              _previous(detail::CurrentResourceSlot()) {
+            detail::CurrentResourceSlot() = &_resource;
+        }
+
+        ~ScopedArena() {
+            detail::CurrentResourceSlot() = _previous;
+            _resource.release();
+
+            if (_buffer == nullptr) {
+                return;
+            }
+
+            const size_t limit = MaxRetainedSize();
+            const size_t used  = _buffer->size + _upstream.allocated();
+            if (_buffer->size > limit) {
+                _buffer->data.reset();
+                _buffer->size = 0;
+            } else if (used > _buffer->size && _buffer->size < limit) {
+                const size_t size = std::min(used, limit);
+                _buffer->data     = std::make_unique_for_overwrite<std::byte[]>(size);
+                _buffer->size     = size;
+            }
+
+            std::lock_guard<std::mutex> lock(detail::ArenaBuffers().mutex);
+            _buffer->in_use = false;
+        }
+
+        ScopedArena(const ScopedArena&)            = delete;
+        ScopedArena& operator=(const ScopedArena&) = delete;
+
+        [[nodiscard]] std::pmr::memory_resource* resource() { return &_resource; }
+
+    private:
+        detail::RetainedArenaBuffer*        _buffer;
+        detail::CountingResource            _upstream;
+        std::pmr::monotonic_buffer_resource _resource;
+        std::pmr::memory_resource*          _previous;
+
+        static detail::RetainedArenaBuffer* AcquireBuffer() {
+            detail::RetainedArenaBuffer& buffer = detail::ThreadArenaBuffer();
+            {
+                std::lock_guard<std::mutex> lock(detail::ArenaBuffers().mutex);
+                if (buffer.in_use) {
+                    return nullptr;
+                }
+                buffer.in_use = true;
+            }
+
+            const size_t size = std::min(kInitialSize, MaxRetainedSize());
+            if (buffer.data == nullptr && size > 0) {
+                buffer.data = std::make_unique_for_overwrite<std::byte[]>(size);
+                buffer.size = size;
+            }
+            return &buffer;
+        }
+    };
+
+    // Временно возвращает ast-контейнеры потока на кучу (внутри ScopedArena)
+    class HeapScope {
+    public:
+        HeapScope() : _previous(detail::CurrentResourceSlot()) {
+            detail::CurrentResourceSlot() = nullptr;
+        }
+        ~HeapScope() { detail::CurrentResourceSlot() = _previous; }
+
+        HeapScope(const HeapScope&)            = delete;
+        HeapScope& operator=(const HeapScope&) = delete;
+
+    private:
+        std::pmr::memory_resource* _previous;
+    };
+}
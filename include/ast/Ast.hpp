@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <map>
 #include <variant>
@@ -9,44 +16,328 @@
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 
+#include "ast/Arena.hpp"
+#include "ast/Decimal.hpp"
+
 namespace ast {
 
     using namespace rapidjson;
 
-    // ====================== JSONValue ======================
+    // ====================== JSONKey ======================
+
+    /**
+     * Interned object key. Equal keys share one std::string from a process-wide pool, so a key
+     * is a single pointer and can be emitted as a rapidjson StringRef. Meant for identifier keys
+     * ("type", "props", column keys), not for arbitrary data.
+     *
+     * A key first interned outside a ScopedArena (statics, caches under HeapScope) is pinned for
+     * the life of the process. Keys that only request arenas have seen are dropped by
+     * ReleaseRequestKeys(), which the plugin calls in DestroyReport once the trees holding them
+     * are gone.
+     */
+    class JSONKey {
+    public:
+        JSONKey() : _value(&Intern({})) {}
+        JSONKey(const char* key) : _value(&Intern(key)) {}
+        JSONKey(std::string_view key) : _value(&Intern(key)) {}
+        JSONKey(const std::string& key) : _value(&Intern(key)) {}
+
+        [[nodiscard]] const std::string& str() const { return *_value; }
+        [[nodiscard]] const char* c_str() const { return _value->c_str(); }
+        [[nodiscard]] size_t size() const { return _value->size(); }
+
+        operator const std::string&() const { return *_value; }
+        operator std::string_view() const { return *_value; }
+
+        // Ссылка на строку пула без копирования
+        [[nodiscard]] GenericStringRef<char> ref() const {
+            return {_value->data(), static_cast<SizeType>(_value->size())};
+        }
+
+        friend bool operator==(const JSONKey& lhs, const JSONKey& rhs) {
+            return lhs._value == rhs._value;
+        }
+
+        // Удаляет незакрепленные ключи; ни одного JSONKey на них уже не должно быть
+        static void ReleaseRequestKeys() {
+            Pool&                       pool = SharedPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            std::erase_if(pool.keys, [](const auto& key) { return !key.second; });
+            pool.generation.fetch_add(1, std::memory_order_release);
+        }
+
+        [[nodiscard]] static size_t PoolSize() {
+            Pool&                       pool = SharedPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            return pool.keys.size();
+        }
+
+    private:
+        const std::string* _value;
+
+        // Ключ -> закреплен (впервые встречен вне арены)
+        struct Pool {
+            std::mutex                            mutex;
+            std::unordered_map<std::string, bool> keys;
+            std::atomic<uint64_t>                 generation{0};
+        };
+
+        // Кэш потока перед пулом; сбрасывается, когда ReleaseRequestKeys сменил поколение
+        struct ThreadCache {
+            using Entry = std::pair<const std::string*, bool>;
+
+            uint64_t                                    generation = 0;
+            std::unordered_map<std::string_view, Entry> keys;
+        };
+
+        static Pool& SharedPool() {
+            // Не разрушается: кэши потоков хоста могут пережить статики
+            static auto* pool = new Pool;
+            return *pool;
+        }
+
+        static const std::string& Intern(const std::string_view key) {
+            thread_local ThreadCache cache;
+
+            Pool&          pool       = SharedPool();
+            const uint64_t generation = pool.generation.load(std::memory_order_acquire);
+            if (cache.generation != generation) {
+                cache.keys.clear();
+                cache.generation = generation;
+            }
+
+            const bool pin = CurrentResource() == nullptr;
+            if (const auto it = cache.keys.find(key);
+                it != cache.keys.end() && (it->second.second || !pin)) {
+                return *it->second.first;
+            }
+
+            const std::string* interned;
+            bool               pinned;
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                auto& entry = *pool.keys.emplace(key, pin).first;
+                entry.second |= pin;
+                interned = &entry.first;
+                pinned   = entry.second;
+            }
+
+            cache.keys.insert_or_assign(*interned, std::make_pair(interned, pinned));
+            return *interned;
+        }
+    };
+
+    // ====================== JSONObject ======================
+
+    // Строки, массивы и объекты ast берут память у CurrentResource() (см. Arena.hpp)
+    using String = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
 
     struct JSONValue;
-    using JSONArray  = std::vector<JSONValue>;
-    using JSONObject = std::map<std::string, JSONValue>;
+    using JSONArray = std::vector<JSONValue, ArenaAllocator<JSONValue>>;
+
+    /**
+     * Flat object: properties live in one vector sorted by key, so iteration order is the
+     * same as it was with std::map<std::string, JSONValue>. Lookups are binary searches,
+     * inserts shift the tail - objects here are small. There is no inline small-object buffer:
+     * under the request arena the vector is one bump allocation already, and a buffer would
+     * make every object (and every JSONValue holding one) larger.
+     */
+    class JSONObject {
+    public:
+        using value_type     = std::pair<JSONKey, JSONValue>;
+        using storage_type   = std::vector<value_type, ArenaAllocator<value_type>>;
+        using iterator       = storage_type::iterator;
+        using const_iterator = storage_type::const_iterator;
+
+        using allocator_type = storage_type::allocator_type;
+
+        JSONObject() = default;
+        JSONObject(std::initializer_list<value_type> properties);
+        JSONObject(const JSONObject&)            = default;
+        JSONObject(JSONObject&&)                 = default;
+        JSONObject& operator=(const JSONObject&) = default;
+        JSONObject& operator=(JSONObject&&)      = default;
+
+        // Свойства строятся в ресурсе alloc; при другом ресурсе перенос копирует
+        JSONObject(std::allocator_arg_t, const allocator_type& alloc) : _properties(alloc) {}
+        JSONObject(std::allocator_arg_t, const allocator_type& alloc, const JSONObject& other)
+            : _properties(other._properties, alloc) {}
+        JSONObject(std::allocator_arg_t, const allocator_type& alloc, JSONObject&& other)
+            : _properties(std::move(other._properties), alloc) {}
+
+        // Как у std::map: при повторном ключе остается первое значение
+        std::pair<iterator, bool> insert(value_type property);
+
+        JSONValue& operator[](const JSONKey& key);
+
+        [[nodiscard]] iterator find(std::string_view key);
+        [[nodiscard]] const_iterator find(std::string_view key) const;
+        [[nodiscard]] bool contains(std::string_view key) const;
+
+        void reserve(size_t size);
+        void swap(JSONObject& other) noexcept;
+        // Освобождает память свойств, оставляя объекту его ресурс
+        void release() noexcept;
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] bool empty() const;
+
+        iterator begin();
+        iterator end();
+        [[nodiscard]] const_iterator begin() const;
+        [[nodiscard]] const_iterator end() const;
+
+    private:
+        storage_type _properties;
+
+        template <typename Iterator>
+        static Iterator LowerBound(Iterator first, Iterator last, std::string_view key);
+    };
 
     /**
      * Represents a dynamic JSON-like value that can store:
-     * - string
+     * - string (String)
      * - double
      * - bool
      * - array (JSONArray)
      * - object (JSONObject)
+     * - integer (int64_t)
+     * - fixed-point decimal (Decimal), written as a number
      */
     struct JSONValue {
-        std::variant<std::string, double, bool, JSONArray, JSONObject> value;
+        std::variant<String, double, bool, JSONArray, JSONObject, int64_t, Decimal> value;
 
         JSONValue() = default;
-        JSONValue(const char* s) : value(std::string(s)) {}
-        JSONValue(const std::string& s) : value(s) {}
+        JSONValue(const char* s) : value(String(s)) {}
+        JSONValue(std::string_view s) : value(String(s.data(), s.size())) {}
+        JSONValue(const std::string& s) : value(String(s.data(), s.size())) {}
+        JSONValue(const String& s) : value(s) {}
+        JSONValue(String&& s) : value(std::move(s)) {}
         JSONValue(double d) : value(d) {}
+        JSONValue(int i) : value(static_cast<int64_t>(i)) {}
+        JSONValue(int64_t i) : value(i) {}
+        JSONValue(const Decimal& d) : value(d) {}
         JSONValue(bool b) : value(b) {}
         JSONValue(const JSONArray& arr) : value(arr) {}
+        JSONValue(JSONArray&& arr) : value(std::move(arr)) {}
         JSONValue(const JSONObject& obj) : value(obj) {}
+        JSONValue(JSONObject&& obj) : value(std::move(obj)) {}
+
+        JSONValue(const JSONValue&)            = default;
+        JSONValue(JSONValue&&)                 = default;
+        JSONValue& operator=(const JSONValue&) = default;
+        JSONValue& operator=(JSONValue&&)      = default;
+
+        // Элемент JSONArray/JSONObject: строки, массивы и объекты значения переходят в ресурс
+        // контейнера (см. ArenaAllocator)
+        using allocator_type = ArenaAllocator<JSONValue>;
+
+        JSONValue(std::allocator_arg_t, const allocator_type&) {}
+        JSONValue(std::allocator_arg_t, const allocator_type& alloc, const JSONValue& other);
+        JSONValue(std::allocator_arg_t, const allocator_type& alloc, JSONValue&& other);
+
+        template <typename Arg>
+            requires(!std::is_same_v<std::remove_cvref_t<Arg>, JSONValue>)
+        JSONValue(std::allocator_arg_t, const allocator_type&, Arg&& arg)
+            : JSONValue(std::forward<Arg>(arg)) {}
     };
 
+    inline JSONValue::JSONValue(std::allocator_arg_t,
+                                const allocator_type& alloc,
+                                const JSONValue&      other) {
+        std::visit([&](const auto& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, String> || std::is_same_v<T, JSONArray>)
+                value.template emplace<T>(arg, typename T::allocator_type(alloc));
+            else if constexpr (std::is_same_v<T, JSONObject>)
+                value.template emplace<T>(std::allocator_arg, alloc, arg);
+            else
+                value = arg;
+        }, other.value);
+    }
+
+    inline JSONValue::JSONValue(std::allocator_arg_t,
+                                const allocator_type& alloc,
+                                JSONValue&&           other) {
+        std::visit([&](auto& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, String> || std::is_same_v<T, JSONArray>)
+                value.template emplace<T>(std::move(arg), typename T::allocator_type(alloc));
+            else if constexpr (std::is_same_v<T, JSONObject>)
+                value.template emplace<T>(std::allocator_arg, alloc, std::move(arg));
+            else
+                value = arg;
+        }, other.value);
+    }
+
+    // Тела методов JSONObject - после JSONValue: std::pair<JSONKey, JSONValue> должен быть полным
+
+    inline bool JSONObject::contains(const std::string_view key) const { return find(key) != end(); }
+
+    inline void JSONObject::reserve(const size_t size) { _properties.reserve(size); }
+    inline void JSONObject::swap(JSONObject& other) noexcept { _properties.swap(other._properties); }
+    inline void JSONObject::release() noexcept {
+        storage_type(_properties.get_allocator()).swap(_properties);
+    }
+    inline size_t JSONObject::size() const { return _properties.size(); }
+    inline bool JSONObject::empty() const { return _properties.empty(); }
+
+    inline JSONObject::iterator JSONObject::begin() { return _properties.begin(); }
+    inline JSONObject::iterator JSONObject::end() { return _properties.end(); }
+    inline JSONObject::const_iterator JSONObject::begin() const { return _properties.begin(); }
+    inline JSONObject::const_iterator JSONObject::end() const { return _properties.end(); }
+
+    inline JSONObject::JSONObject(const std::initializer_list<value_type> properties) {
+        _properties.reserve(properties.size());
+        for (const auto& property : properties) {
+            insert(property);
+        }
+    }
+
+    template <typename Iterator>
+    Iterator JSONObject::LowerBound(Iterator first, Iterator last, const std::string_view key) {
+        return std::lower_bound(first, last, key, [](const value_type& property, std::string_view k) {
+            return property.first.str() < k;
+        });
+    }
+
+    inline std::pair<JSONObject::iterator, bool> JSONObject::insert(value_type property) {
+        const auto it = LowerBound(_properties.begin(), _properties.end(), property.first.str());
+        if (it != _properties.end() && it->first == property.first) {
+            return {it, false};
+        }
+        return {_properties.insert(it, std::move(property)), true};
+    }
+
+    inline JSONValue& JSONObject::operator[](const JSONKey& key) {
+        const auto it = LowerBound(_properties.begin(), _properties.end(), key.str());
+        if (it != _properties.end() && it->first == key) {
+            return it->second;
+        }
+        return _properties.insert(it, value_type{key, JSONValue()})->second;
+    }
+
+    inline JSONObject::iterator JSONObject::find(const std::string_view key) {
+        const auto it = LowerBound(_properties.begin(), _properties.end(), key);
+        return it != _properties.end() && it->first.str() == key ? it : _properties.end();
+    }
+
+    inline JSONObject::const_iterator JSONObject::find(const std::string_view key) const {
+        const auto it = LowerBound(_properties.begin(), _properties.end(), key);
+        return it != _properties.end() && it->first.str() == key ? it : _properties.end();
+    }
+
     // Recursive serialization for JSONValue
     inline void to_json_value(const JSONValue& jv, Value& out, Document::AllocatorType& alloc) {
         std::visit([&](auto&& arg) {
             using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, std::string>)
-                out.SetString(arg.c_str(), alloc);
+            if constexpr (std::is_same_v<T, String>)
+                out.SetString(arg.c_str(), static_cast<SizeType>(arg.size()), alloc);
             else if constexpr (std::is_same_v<T, double>)
                 out.SetDouble(arg);
+            else if constexpr (std::is_same_v<T, int64_t>)
+                out.SetInt64(arg);
+            else if constexpr (std::is_same_v<T, Decimal>)
+                out.SetDouble(arg.ToDouble());
             else if constexpr (std::is_same_v<T, bool>)
                 out.SetBool(arg);
             else if constexpr (std::is_same_v<T, JSONArray>) {
@@ -58,49 +349,173 @@ namespace ast {
                 }
             } else if constexpr (std::is_same_v<T, JSONObject>) {
                 out.SetObject();
+                out.MemberReserve(static_cast<SizeType>(arg.size()), alloc);
                 for (const auto& [k, v] : arg) {
-                    Value key(k.c_str(), alloc);
                     Value val;
                     to_json_value(v, val, alloc);
-                    out.AddMember(key, val, alloc);
+                    out.AddMember(k.ref(), val, alloc);
+                }
+            }
+        }, jv.value);
+    }
+
+    // Consuming serialization: every string, array and object is released as soon as it has
+    // been written, so the tree and the rapidjson copy do not both stay alive at full size.
+    // jv is left empty.
+    inline void to_json_value(JSONValue&& jv, Value& out, Document::AllocatorType& alloc) {
+        std::visit([&](auto& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, String>) {
+                out.SetString(arg.c_str(), static_cast<SizeType>(arg.size()), alloc);
+                String(arg.get_allocator()).swap(arg);
+            } else if constexpr (std::is_same_v<T, double>)
+                out.SetDouble(arg);
+            else if constexpr (std::is_same_v<T, int64_t>)
+                out.SetInt64(arg);
+            else if constexpr (std::is_same_v<T, Decimal>)
+                out.SetDouble(arg.ToDouble());
+            else if constexpr (std::is_same_v<T, bool>)
+                out.SetBool(arg);
+            else if constexpr (std::is_same_v<T, JSONArray>) {
+                out.SetArray();
+                out.Reserve(static_cast<SizeType>(arg.size()), alloc);
+                for (auto& el : arg) {
+                    Value item;
+                    to_json_value(std::move(el), item, alloc);
+                    out.PushBack(item, alloc);
+                }
+                JSONArray(arg.get_allocator()).swap(arg);
+            } else if constexpr (std::is_same_v<T, JSONObject>) {
+                out.SetObject();
+                out.MemberReserve(static_cast<SizeType>(arg.size()), alloc);
+                for (auto& [k, v] : arg) {
+                    Value val;
+                    to_json_value(std::move(v), val, alloc);
+                    out.AddMember(k.ref(), val, alloc);
                 }
+                arg.release();
+            }
+        }, jv.value);
+    }
+
+    // Decimal SAX-событием. JSON-писатели получают тот же текст, что DOM-путь печатает через
+    // SetDouble(ToDouble()) (1000.0, 1234.5), но без печати double; CborWriter - RawNumber с
+    // текстом Decimal::Write (целое или decimal fraction)
+    template <typename Handler>
+    bool write_json_decimal(const Decimal& value, Handler& handler) {
+        char buffer[Decimal::kMaxChars];
+        if constexpr (requires { handler.RawValue(buffer, size_t{}, kNumberType); }) {
+            if (!value.HasExactJson()) {
+                return handler.Double(value.ToDouble());
+            }
+            return handler.RawValue(buffer, value.WriteJson(buffer), kNumberType);
+        } else {
+            return handler.RawNumber(buffer, static_cast<SizeType>(value.Write(buffer)), true);
+        }
+    }
+
+    // SAX-сериализация: события идут прямо в rapidjson Handler (Writer, PrettyWriter, ...),
+    // без промежуточного Document
+    template <typename Handler>
+    bool write_json_value(const JSONValue& jv, Handler& handler) {
+        return std::visit([&](const auto& arg) -> bool {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, String>)
+                return handler.String(arg.c_str(), static_cast<SizeType>(arg.size()), true);
+            else if constexpr (std::is_same_v<T, double>)
+                return handler.Double(arg);
+            else if constexpr (std::is_same_v<T, int64_t>)
+                return handler.Int64(arg);
+            else if constexpr (std::is_same_v<T, Decimal>)
+                return write_json_decimal(arg, handler);
+            else if constexpr (std::is_same_v<T, bool>)
+                return handler.Bool(arg);
+            else if constexpr (std::is_same_v<T, JSONArray>) {
+                if (!handler.StartArray())
+                    return false;
+                for (const auto& el : arg) {
+                    if (!write_json_value(el, handler))
+                        return false;
+                }
+                return handler.EndArray(static_cast<SizeType>(arg.size()));
+            } else {
+                if (!handler.StartObject())
+                    return false;
+                for (const auto& [k, v] : arg) {
+                    if (!handler.Key(k.c_str(), static_cast<SizeType>(k.size()), true) ||
+                        !write_json_value(v, handler))
+                        return false;
+                }
+                return handler.EndObject(static_cast<SizeType>(arg.size()));
             }
         }, jv.value);
     }
 
     // ====================== Node AST ======================
 
+    struct Node;
+    using NodeList = std::vector<Node, ArenaAllocator<Node>>;
+
     struct Node {
-        std::string type;
+        String type;
         JSONObject props;
-        std::vector<Node> children;
+        NodeList children;
+
+        Node() = default;
+        Node(String node_type, JSONObject node_props, NodeList node_children)
+            : type(std::move(node_type)),
+              props(std::move(node_props)),
+              children(std::move(node_children)) {}
+
+        Node(const Node&)            = default;
+        Node(Node&&)                 = default;
+        Node& operator=(const Node&) = default;
+        Node& operator=(Node&&)      = default;
+
+        // Элемент NodeList строится в ресурсе списка, как JSONValue
+        using allocator_type = ArenaAllocator<Node>;
+
+        Node(std::allocator_arg_t, const allocator_type& alloc)
+            : type(String::allocator_type(alloc)),
+              props(std::allocator_arg, JSONObject::allocator_type(alloc)),
+              children(alloc) {}
+        Node(std::allocator_arg_t, const allocator_type& alloc, const Node& other)
+            : type(other.type, String::allocator_type(alloc)),
+              props(std::allocator_arg, JSONObject::allocator_type(alloc), other.props),
+              children(other.children, alloc) {}
+        Node(std::allocator_arg_t, const allocator_type& alloc, Node&& other)
+            : type(std::move(other.type), String::allocator_type(alloc)),
+              props(std::allocator_arg, JSONObject::allocator_type(alloc), std::move(other.props)),
+              children(std::move(other.children), alloc) {}
     };
 
     // ---------- Constructors ----------
 
     inline Node element(
-        const std::string& type,
-        std::vector<Node> children = {},
+        std::string_view type,
+        NodeList children = {},
         JSONObject props = {}
     ) {
-        return Node{type, std::move(props), std::move(children)};
+        return Node{String(type.data(), type.size()), std::move(props), std::move(children)};
     }
 
-    inline Node text(const std::string& value) {
-        return Node{"#text", {{"value", JSONValue(value)}}, {}};
+    inline Node text(std::string_view value) {
+        JSONObject props;
+        props["value"] = value;
+        return Node{"#text", std::move(props), {}};
     }
 
     // ---------- TAG macro ----------
 
     #define TAG(name) \
-    inline Node name(std::vector<Node> children = {}, JSONObject props = {}) { \
+    inline Node name(NodeList children = {}, JSONObject props = {}) { \
         return element(#name, std::move(children), std::move(props)); \
     }
 
     // ---------- TAG with type macro ----------
 
     #define TAG_WITH_TYPE(func_name, type_name) \
-    inline Node func_name(std::vector<Node> children = {}, JSONObject props = {}) { \
+    inline Node func_name(NodeList children = {}, JSONObject props = {}) { \
         return element(type_name, std::move(children), std::move(props)); \
     }
 
@@ -181,7 +596,7 @@ namespace ast {
 
     // ---------- Props helper ----------
 
-    inline JSONObject props(std::initializer_list<std::pair<const std::string, JSONValue>> kv) {
+    inline JSONObject props(std::initializer_list<JSONObject::value_type> kv) {
         return JSONObject(kv);
     }
 
@@ -189,15 +604,17 @@ namespace ast {
 
     inline void to_json(const Node& node, Value& out, Document::AllocatorType& alloc) {
         out.SetObject();
-        out.AddMember("type", Value(node.type.c_str(), alloc), alloc);
+        out.AddMember("type",
+                      Value(node.type.c_str(), static_cast<SizeType>(node.type.size()), alloc),
+                      alloc);
 
         if (!node.props.empty()) {
             Value propsObj(kObjectType);
+            propsObj.MemberReserve(static_cast<SizeType>(node.props.size()), alloc);
             for (auto& [k, v] : node.props) {
-                Value key(k.c_str(), alloc);
                 Value val;
                 to_json_value(v, val, alloc);
-                propsObj.AddMember(key, val, alloc);
+                propsObj.AddMember(k.ref(), val, alloc);
             }
             out.AddMember("props", propsObj, alloc);
         }
@@ -213,20 +630,85 @@ namespace ast {
         }
     }
 
+    // Consuming variant: props and children are moved out and released as they are written
+    inline void to_json(Node&& node, Value& out, Document::AllocatorType& alloc) {
+        out.SetObject();
+        out.AddMember("type",
+                      Value(node.type.c_str(), static_cast<SizeType>(node.type.size()), alloc),
+                      alloc);
+
+        if (!node.props.empty()) {
+            Value propsObj(kObjectType);
+            propsObj.MemberReserve(static_cast<SizeType>(node.props.size()), alloc);
+            for (auto& [k, v] : node.props) {
+                Value val;
+                to_json_value(std::move(v), val, alloc);
+                propsObj.AddMember(k.ref(), val, alloc);
+            }
+            node.props.release();
+            out.AddMember("props", propsObj, alloc);
+        }
+
+        if (!node.children.empty()) {
+            Value childrenArr(kArrayType);
+            childrenArr.Reserve(static_cast<SizeType>(node.children.size()), alloc);
+            for (auto& c : node.children) {
+                Value child(kObjectType);
+                to_json(std::move(c), child, alloc);
+                childrenArr.PushBack(child, alloc);
+            }
+            NodeList(node.children.get_allocator()).swap(node.children);
+            out.AddMember("children", childrenArr, alloc);
+        }
+    }
+
+    // Same members and order as to_json(), emitted as SAX events
+    template <typename Handler>
+    bool write_json(const Node& node, Handler& handler) {
+        SizeType members = 1;
+        if (!handler.StartObject() ||
+            !handler.Key("type", 4, false) ||
+            !handler.String(node.type.c_str(), static_cast<SizeType>(node.type.size()), true))
+            return false;
+
+        if (!node.props.empty()) {
+            ++members;
+            if (!handler.Key("props", 5, false) || !handler.StartObject())
+                return false;
+            for (auto& [k, v] : node.props) {
+                if (!handler.Key(k.c_str(), static_cast<SizeType>(k.size()), true) ||
+                    !write_json_value(v, handler))
+                    return false;
+            }
+            if (!handler.EndObject(static_cast<SizeType>(node.props.size())))
+                return false;
+        }
+
+        if (!node.children.empty()) {
+            ++members;
+            if (!handler.Key("children", 8, false) || !handler.StartArray())
+                return false;
+            for (auto& c : node.children) {
+                if (!write_json(c, handler))
+                    return false;
+            }
+            if (!handler.EndArray(static_cast<SizeType>(node.children.size())))
+                return false;
+        }
+
+        return handler.EndObject(members);
+    }
+
     // ---------- stringify ----------
 
     inline std::string stringify(const Node& node) {
-        Document doc;
-        doc.SetObject();
-        auto& alloc = doc.GetAllocator();
-        to_json(node, doc, alloc);
         StringBuffer buffer;
         Writer<StringBuffer> writer(buffer);
-        doc.Accept(writer);
+        write_json(node, writer);
         return buffer.GetString();
     }
 
     // ---------- none helper ----------
 
-    inline std::vector<Node> none() { return {}; }
+    inline NodeList none() { return {}; }
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace ast {
+
+    // Fixed-point decimal: units / 10^digits. Used for the monetary cells and totals of the report,
+    // so truncation is exact and formatting is integer arithmetic instead of double printing.
+    struct Decimal {
+        static constexpr int    kMaxDigits = 8;
+        static constexpr size_t kMaxChars  = 22; // знак, 19 цифр int64, точка и запас (".0")
+
+        int64_t units  = 0;
+        uint8_t digits = 2;
+
+        // Отбрасывает знаки после digits, как utils::TruncateDouble, но без std::pow.
+        // Произведение value * 10^digits может оказаться на несколько ulp ниже целого
+        // (1234.57 * 100 = 123456.99999999999) - такие значения притягиваются к целому.
+        // NaN, бесконечности и значения вне диапазона int64 дают 0.
+        static Decimal Truncate(const double value, const int digits = 2) {
+            const int    scale  = std::clamp(digits, 0, kMaxDigits);
+            const double scaled = value * kPow10Double[scale];
+
+            if (!std::isfinite(scaled) || std::abs(scaled) >= 9.2e18) {
+                return {0, static_cast<uint8_t>(scale)};
+            }
+
+            const double magnitude = std::abs(scaled);
+            const double snap =
+                std::max(1e-9, magnitude * 4 * std::numeric_limits<double>::epsilon());
+
+            auto whole = static_cast<int64_t>(magnitude);
+            if (magnitude - static_cast<double>(whole) >= 1.0 - snap) {
+                ++whole;
+            }
+
+            return {scaled < 0 ? -whole : whole, static_cast<uint8_t>(scale)};
+        }
+
+        // Ближайший к десятичному значению double: печатается без хвостов вида 1234.5699999
+        [[nodiscard]] double ToDouble() const {
+            return static_cast<double>(units) / kPow10Double[digits];
+        }
+
+        [[nodiscard]] bool IsWhole() const { return units % kPow10[digits] == 0; }
+
+        [[nodiscard]] int64_t Whole() const { return units / kPow10[digits]; }
+
+        // Пишет десятичное представление в out (не меньше kMaxChars байт) без завершающего нуля,
+        // возвращает длину. Нули в конце дробной части не пишутся:
+        // 1234.50 -> "1234.5", 1000.00 -> "1000"
+        size_t Write(char* out) const {
+            const bool     negative  = units < 0;
+            const uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(units)
+                                                : static_cast<uint64_t>(units);
+            const auto     scale     = static_cast<uint64_t>(kPow10[digits]);
+
+            uint64_t whole           = magnitude / scale;
+            uint64_t fraction        = magnitude % scale;
+            int      fraction_digits = digits;
+
+            while (fraction_digits > 0 && fraction % 10 == 0) {
+                fraction /= 10;
+                --fraction_digits;
+            }
+
+            char* position = out;
+            if (negative) {
+                *position++ = '-';
+            }
+
+            position += WriteUnsigned(whole, position);
+
+            if (fraction_digits > 0) {
+                *position++ = '.';
+                WriteFixed(fraction, fraction_digits, position);
+                position += fraction_digits;
+            }
+
+            return static_cast<size_t>(position - out);
+        }
+
+        // Текст, который rapidjson Writer::Double печатает для ToDouble(): целые - с ".0"
+        // (1000.0), остальное - как Write. Верно, пока ToDouble() точно возвращается в текст
+        // (HasExactJson, до 15 значащих цифр)
+        size_t WriteJson(char* out) const {
+            size_t size = Write(out);
+            if (IsWhole()) {
+                out[size++] = '.';
+                out[size++] = '0';
+            }
+            return size;
+        }
+
+        [[nodiscard]] bool HasExactJson() const { return units > -kMaxExactUnits && units < kMaxExactUnits; }
+
+        [[nodiscard]] std::string ToString() const {
+            char buffer[kMaxChars];
+            return {buffer, Write(buffer)};
+        }
+
+        friend bool operator==(const Decimal& lhs, const Decimal& rhs) = default;
+
+        static constexpr std::array<int64_t, kMaxDigits + 1> kPow10 = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+        static constexpr std::array<double, kMaxDigits + 1> kPow10Double = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+
+        // 10^15: любое десятичное число до 15 значащих цифр переживает double без потерь
+        static constexpr int64_t kMaxExactUnits = 1000000000000000;
+
+    private:
+        // "00" "01" ... "99": две цифры за одно деление
+        static constexpr std::array<char, 200> kDigitPairs = [] {
+            std::array<char, 200> pairs{};
+            for (int i = 0; i < 100; ++i) {
+                pairs[i * 2]     = static_cast<char>('0' + i / 10);
+                pairs[i * 2 + 1] = static_cast<char>('0' + i % 10);
+            }
+            return pairs;
+        }();
+
+        static size_t WriteUnsigned(uint64_t value, char* out) {
+            char  buffer[20];
+            char* end      = buffer + sizeof(buffer);
+            char* position = end;
+
+            while (value >= 100) {
+                const size_t pair = static_cast<size_t>(value % 100) * 2;
+                value /= 100;
+                position -= 2;
+                std::memcpy(position, kDigitPairs.data() + pair, 2);
+            }
+
+            if (value >= 10) {
+                position -= 2;
+                std::memcpy(position, kDigitPairs.data() + value * 2, 2);
+            } else {
+                *--position = static_cast<char>('0' + value);
+            }
+
+            const auto size = static_cast<size_t>(end - position);
+            std::memcpy(out, position, size);
+            return size;
+        }
+
+        // Ровно width цифр с ведущими нулями
+        static void WriteFixed(uint64_t value, const int width, char* out) {
+            for (int i = width - 1; i >= 0; --i) {
+                out[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+        }
+    };
+
+} // namespace ast
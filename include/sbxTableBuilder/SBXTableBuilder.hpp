@@ -1,10 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <optional>
 #include "ast/Ast.hpp"
+#include "ast/Decimal.hpp"
 
 using namespace ast;
 
@@ -84,13 +92,46 @@ struct TableColumn {
     bool is_sorted = true;              // Доступна ли сортировка (может отсутствовать)
 };
 
+// Тип хранения значений колонки
+enum class ColumnType {
+    Value,               // Произвольные значения (JSONValue)
+    Double,              // Числа с плавающей точкой
+    Int64,               // Целые числа
+    String,              // Интернированные строки (в строке хранится код)
+    Decimal,             // Фиксированная точка: int64 единиц по 10^-digits
+    Dictionary           // Строки со словарем колонки: в строке хранится код значения
+};
+
+// Код значения в словаре колонки ColumnType::Dictionary (см. TableBuilder::SetDictionary)
+struct DictionaryCode {
+    uint32_t code = 0;
+};
+
+// Серверная пагинация таблицы (props.pagination)
+struct TablePagination {
+    size_t total = 0;          // Строк во всей выборке
+    size_t offset = 0;         // Позиция первой строки страницы
+    size_t limit = 0;          // Размер страницы
+    bool has_more = false;     // Есть ли следующая страница
+    std::string next_cursor;   // Курсор следующей страницы (пустой, если ее нет)
+};
+
+// Ответ-дельта (props.delta): rows содержат только добавленные и измененные строки
+struct TableDelta {
+    std::string since;              // Версия, относительно которой собрана дельта
+    std::vector<int64_t> removed;   // idCol строк, удаленных после since
+};
+
 // Основной класс для пошаговой сборки JSON-описания таблицы
 class TableBuilder {
 public:
-    explicit TableBuilder(const std::string& table_name)
-        : _table_name(table_name) {}
+    explicit TableBuilder(std::string table_name)
+        : _table_name(std::move(table_name)) {}
 
-    void AddColumn(const TableColumn& column) {
+    // decimal_digits - число знаков после точки для колонок ColumnType::Decimal
+    void AddColumn(const TableColumn& column,
+                   const ColumnType type = ColumnType::Value,
+                   const int decimal_digits = 2) {
         _column_order_by_keys.push_back(column.key);
 
         JSONObject column_obj;
@@ -103,20 +144,109 @@ public:
             column_obj["filter"] = ConvertFilterToJson(*column.filter);
         }
 
+        ThawStructure();
         _structure[column.key] = std::move(column_obj);
+
+        ColumnData column_data;
+        column_data.type = type;
+        column_data.digits = static_cast<uint8_t>(std::clamp(decimal_digits, 0, Decimal::kMaxDigits));
+        column_data.Resize(_rows_count);
+        _columns.push_back(std::move(column_data));
     }
 
+    // Строки хранятся по колонкам: i-е значение строки попадает в i-ю колонку и приводится к ее типу.
+    // Лишние значения получают безымянные колонки ColumnType::Value, недостающие - значения по умолчанию.
     void AddRow(const std::vector<JSONValue>& row_values) {
-        JSONArray json_row;
-        json_row.reserve(row_values.size());
+        EnsureColumns(row_values.size());
+
+        for (size_t i = 0; i < row_values.size(); ++i) {
+            AppendCell(_columns[i], row_values[i]);
+        }
+
+        FinishRow(row_values.size());
+    }
+
+    // То же, но значения колонок ColumnType::Value переносятся из row_values без копирования
+    void AddRow(std::vector<JSONValue>&& row_values) {
+        EnsureColumns(row_values.size());
 
-        for (const auto& val : row_values) {
-            json_row.push_back(val);
+        for (size_t i = 0; i < row_values.size(); ++i) {
+            AppendCell(_columns[i], std::move(row_values[i]));
         }
 
-        _rows.push_back(std::move(json_row));
+        FinishRow(row_values.size());
     }
 
+    // Типизированное добавление строки без промежуточных JSONValue
+    template <typename... Cells>
+    void AppendRow(Cells&&... cells) {
+        EnsureColumns(sizeof...(Cells));
+
+        size_t column = 0;
+        (AppendCell(_columns[column++], std::forward<Cells>(cells)), ...);
+
+        FinishRow(sizeof...(Cells));
+    }
+
+    void ReserveRows(const size_t rows_count) {
+        for (auto& column : _columns) {
+            column.Reserve(rows_count);
+        }
+    }
+
+    [[nodiscard]] size_t RowsCount() const { return _rows_count; }
+
+    // Индекс колонки по ключу (в порядке AddColumn), -1 если колонки нет
+    [[nodiscard]] int ColumnIndex(const std::string& key) const {
+        for (size_t i = 0; i < _column_order_by_keys.size(); ++i) {
+            if (_column_order_by_keys[i] == key) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // Непрерывные данные типизированных колонок - для итогов, сортировки и фильтрации
+    [[nodiscard]] const std::vector<double>& GetDoubleColumn(const size_t index) const {
+        return _columns[index].doubles;
+    }
+
+    [[nodiscard]] const std::vector<int64_t>& GetInt64Column(const size_t index) const {
+        return _columns[index].integers;
+    }
+
+    [[nodiscard]] const std::vector<uint32_t>& GetStringCodes(const size_t index) const {
+        return _columns[index].codes;
+    }
+
+    [[nodiscard]] const std::string& GetInternedString(const uint32_t code) const { return _strings[code]; }
+
+    // Задает словарь колонки ColumnType::Dictionary: код значения - его индекс в values, код 0
+    // получают недостающие ячейки. Вызывающий, у которого значения уже интернированы (id валют
+    // GroupIndex), добавляет строки кодами DictionaryCode без поиска строки на каждую ячейку
+    void SetDictionary(const std::string& key, std::vector<std::string> values) {
+        const int index = ColumnIndex(key);
+        if (index < 0 || _columns[index].type != ColumnType::Dictionary) {
+            return;
+        }
+
+        if (values.empty()) {
+            values.emplace_back();
+        }
+
+        ColumnData& column = _columns[index];
+        column.dictionary_codes.clear();
+        for (size_t code = 0; code < values.size(); ++code) {
+            column.dictionary_codes.emplace(values[code], static_cast<uint32_t>(code));
+        }
+        column.dictionary = std::move(values);
+    }
+
+    // Словарное кодирование в ответе: ячейки колонок ColumnType::Dictionary пишутся кодами, а
+    // словари - один раз в data.dictionaries ({"currency": ["N/A", "USD", ...]}). Выключено по
+    // умолчанию: тогда эти колонки пишутся строками, как ColumnType::String
+    void EnableDictionaryEncoding(const bool enabled) { _is_dictionary_encoding_enabled = enabled; }
+
     void SetIdColumn(const std::string& id_column) { _id_column = id_column; }
 
     void SetOrderBy(const std::string& column, const std::string& order = "DESC") {
@@ -139,7 +269,257 @@ public:
 
     void SetTotalData(const JSONArray& total_data) { _total_data = total_data; }
 
-    [[nodiscard]] JSONObject CreateTableProps() const {
+    void SetTotalData(JSONArray&& total_data) { _total_data = std::move(total_data); }
+
+    void SetPagination(const TablePagination& pagination) { _pagination = pagination; }
+
+    // Токен версии данных (props.version), клиент возвращает его для запроса дельты
+    void SetVersion(std::string version) { _version = std::move(version); }
+
+    void SetDelta(TableDelta delta) { _delta = std::move(delta); }
+
+    // Переводит структуру колонок (AddColumn) в rapidjson один раз. Копии builder'а делят ее, и
+    // WriteTableProps клонирует готовое значение в ответ вместо сборки JSONObject на каждый
+    // запрос. Builder-заготовку, которая переживет запрос, замораживают под HeapScope
+    void FreezeStructure() {
+        if (_frozen_structure) {
+            return;
+        }
+
+        auto frozen = std::make_shared<FrozenStructure>();
+        frozen->structure = std::move(_structure);
+        to_json_value(frozen->structure, frozen->json, frozen->json.GetAllocator());
+
+        _structure = JSONObject();
+        _frozen_structure = std::move(frozen);
+    }
+
+    [[nodiscard]] JSONObject CreateTableProps() const& {
+        return BuildTableProps(BuildRows(), Structure(), _total_data);
+    }
+
+    // Забирает строки, структуру и итоги без копирования: std::move(builder).CreateTableProps()
+    [[nodiscard]] JSONObject CreateTableProps() && {
+        if (_frozen_structure) {
+            return BuildTableProps(TakeRows(), Structure(), std::move(_total_data));
+        }
+        return BuildTableProps(TakeRows(), std::move(_structure), std::move(_total_data));
+    }
+
+    // Пишет те же props, что и CreateTableProps(), но data.rows берет из уже готового
+    // rapidjson-массива, а не из строк, добавленных через AddRow
+    void WriteTableProps(Value& rows, Value& out, Document::AllocatorType& allocator) const {
+        if (_frozen_structure) {
+            to_json_value(BuildTableProps({}, {}, _total_data), out, allocator);
+
+            Value structure(_frozen_structure->json, allocator);
+            out["structure"].Swap(structure);
+        } else {
+            to_json_value(BuildTableProps({}, _structure, _total_data), out, allocator);
+        }
+        out["data"]["rows"].Swap(rows);
+    }
+
+    // То же, что и to_json_value(CreateTableProps()), но строки пишутся из колонок напрямую
+    // в rapidjson, колонка за колонкой, без промежуточных JSONArray
+    void WriteTableProps(Value& out, Document::AllocatorType& allocator) const {
+        Value rows(kArrayType);
+        rows.Reserve(static_cast<SizeType>(_rows_count), allocator);
+
+        for (size_t row = 0; row < _rows_count; ++row) {
+            Value row_array(kArrayType);
+            row_array.Reserve(static_cast<SizeType>(_columns.size()), allocator);
+            rows.PushBack(row_array, allocator);
+        }
+
+        for (const auto& column : _columns) {
+            for (size_t row = 0; row < _rows_count; ++row) {
+                Value cell;
+                WriteCell(column, row, cell, allocator);
+                rows[static_cast<SizeType>(row)].PushBack(cell, allocator);
+            }
+        }
+
+        WriteTableProps(rows, out, allocator);
+    }
+
+    // Те же props, что и WriteTableProps(), но SAX-событиями прямо в rapidjson Handler
+    // (Writer, PrettyWriter): строки идут из колонок, без Document в памяти
+    template <typename Handler>
+    bool StreamTableProps(Handler& handler) const {
+        const JSONObject table_props =
+            BuildTableProps({}, _frozen_structure ? JSONObject() : _structure, _total_data);
+
+        if (!handler.StartObject()) {
+            return false;
+        }
+
+        for (const auto& [key, value] : table_props) {
+            if (!handler.Key(key.c_str(), static_cast<SizeType>(key.size()), true)) {
+                return false;
+            }
+
+            bool written;
+            if (key.str() == "data") {
+                written = StreamData(std::get<JSONObject>(value.value), handler);
+            } else if (key.str() == "structure" && _frozen_structure) {
+                written = _frozen_structure->json.Accept(handler);
+            } else {
+                written = write_json_value(value, handler);
+            }
+
+            if (!written) {
+                return false;
+            }
+        }
+
+        return handler.EndObject(static_cast<SizeType>(table_props.size()));
+    }
+
+private:
+    std::string _table_name;
+    std::string _id_column;
+    std::vector<std::string> _column_order_by_keys;
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    using StringCodes = std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>>;
+
+    // Колоночное хранение строк: используется только вектор, соответствующий type
+    struct ColumnData {
+        ColumnType type = ColumnType::Value;
+        uint8_t digits = 2; // ColumnType::Decimal
+        std::vector<double> doubles;
+        std::vector<int64_t> integers;
+        std::vector<uint32_t> codes;
+        JSONArray values;
+
+        // ColumnType::Dictionary: значения колонки, код - индекс (код 0 - пустая строка)
+        std::vector<std::string> dictionary{std::string()};
+        StringCodes dictionary_codes{{std::string(), 0}};
+
+        void Reserve(const size_t size) {
+            switch (type) {
+                case ColumnType::Value: values.reserve(size); break;
+                case ColumnType::Double: doubles.reserve(size); break;
+                case ColumnType::Int64:
+                case ColumnType::Decimal: integers.reserve(size); break;
+                case ColumnType::String:
+                case ColumnType::Dictionary: codes.reserve(size); break;
+            }
+        }
+
+        void Resize(const size_t size) {
+            switch (type) {
+                case ColumnType::Value: values.resize(size); break;
+                case ColumnType::Double: doubles.resize(size, 0.0); break;
+                case ColumnType::Int64:
+                case ColumnType::Decimal: integers.resize(size, 0); break;
+                case ColumnType::String:
+                case ColumnType::Dictionary: codes.resize(size, 0); break;
+            }
+        }
+
+        // Освобождает строки колонки; тип, точность и словарь остаются
+        void ClearRows() {
+            doubles = {};
+            integers = {};
+            codes = {};
+            values = JSONArray();
+        }
+    };
+
+    std::vector<ColumnData> _columns;
+    size_t _rows_count = 0;
+
+    std::vector<std::string> _strings{std::string()}; // код 0 - пустая строка
+    StringCodes _string_codes{{std::string(), 0}};
+    JSONObject _structure;
+
+    // Структура колонок после FreezeStructure(): JSONObject и его rapidjson-копия
+    struct FrozenStructure {
+        JSONValue structure;
+        Document json;
+    };
+
+    std::shared_ptr<const FrozenStructure> _frozen_structure;
+    std::pair<std::string, std::string> _order_by{"id", "DESC"};
+    bool _is_auto_save_enabled = false;
+    bool _is_refresh_button_enabled = true;
+    bool _is_bookmarks_button_enabled = true;
+    bool _is_export_button_enabled = true;
+    bool _is_total_row_enabled = false;
+    bool _is_dictionary_encoding_enabled = false;
+    int _limit = 20;
+    std::string _total_data_title;
+    JSONArray _total_data;
+    std::optional<TablePagination> _pagination;
+    std::string _version;
+    std::optional<TableDelta> _delta;
+
+    [[nodiscard]] const JSONObject& Structure() const {
+        return _frozen_structure ? std::get<JSONObject>(_frozen_structure->structure.value) : _structure;
+    }
+
+    // Возвращает замороженную структуру в _structure перед изменением колонок
+    void ThawStructure() {
+        if (_frozen_structure) {
+            _structure = Structure();
+            _frozen_structure.reset();
+        }
+    }
+
+    [[nodiscard]] JSONArray BuildRows() const {
+        JSONArray json_rows;
+        json_rows.reserve(_rows_count);
+
+        for (size_t row = 0; row < _rows_count; ++row) {
+            JSONArray json_row;
+            json_row.reserve(_columns.size());
+
+            for (const auto& column : _columns) {
+                json_row.push_back(GetCell(column, row));
+            }
+
+            json_rows.emplace_back(std::move(json_row));
+        }
+
+        return json_rows;
+    }
+
+    // Как BuildRows(), но значения колонок ColumnType::Value переносятся; builder остается без строк
+    JSONArray TakeRows() {
+        JSONArray json_rows;
+        json_rows.reserve(_rows_count);
+
+        for (size_t row = 0; row < _rows_count; ++row) {
+            JSONArray json_row;
+            json_row.reserve(_columns.size());
+
+            for (auto& column : _columns) {
+                if (column.type == ColumnType::Value) {
+                    json_row.push_back(std::move(column.values[row]));
+                } else {
+                    json_row.push_back(GetCell(column, row));
+                }
+            }
+
+            json_rows.emplace_back(std::move(json_row));
+        }
+
+        for (auto& column : _columns) {
+            column.ClearRows();
+        }
+        _rows_count = 0;
+
+        return json_rows;
+    }
+
+    [[nodiscard]] JSONObject BuildTableProps(JSONArray json_rows,
+                                             JSONObject structure,
+                                             JSONArray total_data) const {
         JSONObject table_props;
         table_props["name"] = _table_name;
         table_props["idCol"] = _id_column;
@@ -150,22 +530,45 @@ public:
         table_props["showExportBtn"] = _is_export_button_enabled;
         table_props["showTotal"] = _is_total_row_enabled;
         table_props["totalDataTitle"] = _total_data_title;
-        table_props["limit"] = static_cast<double>(_limit);
+        table_props["limit"] = static_cast<int64_t>(_limit);
 
-        if (!_total_data.empty()) {
-            table_props["totalData"] = _total_data;
+        if (!total_data.empty()) {
+            table_props["totalData"] = std::move(total_data);
         }
 
-        JSONObject data_obj;
-        JSONArray json_rows;
-        json_rows.reserve(_rows.size());
+        if (_pagination) {
+            JSONObject pagination_obj;
+            pagination_obj["total"] = static_cast<int64_t>(_pagination->total);
+            pagination_obj["offset"] = static_cast<int64_t>(_pagination->offset);
+            pagination_obj["limit"] = static_cast<int64_t>(_pagination->limit);
+            pagination_obj["hasMore"] = _pagination->has_more;
+
+            if (!_pagination->next_cursor.empty()) {
+                pagination_obj["nextCursor"] = _pagination->next_cursor;
+            }
 
-        for (const auto& row : _rows) {
-            json_rows.emplace_back(row);
+            table_props["pagination"] = std::move(pagination_obj);
         }
 
-        data_obj["rows"] = std::move(json_rows);
+        if (!_version.empty()) {
+            table_props["version"] = _version;
+        }
+
+        if (_delta) {
+            JSONArray removed;
+            removed.reserve(_delta->removed.size());
+            for (const int64_t id : _delta->removed) {
+                removed.emplace_back(id);
+            }
 
+            JSONObject delta_obj;
+            delta_obj["since"] = _delta->since;
+            delta_obj["removed"] = std::move(removed);
+            table_props["delta"] = std::move(delta_obj);
+        }
+
+        JSONObject data_obj;
+        data_obj["rows"] = std::move(json_rows);
 
         JSONArray structure_keys;
         structure_keys.reserve(_column_order_by_keys.size());
@@ -175,27 +578,318 @@ public:
         }
 
         data_obj["structure"] = std::move(structure_keys);
+
+        if (_is_dictionary_encoding_enabled) {
+            JSONObject dictionaries;
+            for (size_t i = 0; i < _columns.size(); ++i) {
+                if (_columns[i].type != ColumnType::Dictionary) {
+                    continue;
+                }
+
+                JSONArray dictionary;
+                dictionary.reserve(_columns[i].dictionary.size());
+                for (const auto& value : _columns[i].dictionary) {
+                    dictionary.emplace_back(value);
+                }
+                dictionaries[_column_order_by_keys[i]] = std::move(dictionary);
+            }
+
+            if (!dictionaries.empty()) {
+                data_obj["dictionaries"] = std::move(dictionaries);
+            }
+        }
+
         table_props["data"] = std::move(data_obj);
-        table_props["structure"] = _structure;
+        table_props["structure"] = std::move(structure);
 
         return table_props;
     }
 
-private:
-    std::string _table_name;
-    std::string _id_column;
-    std::vector<std::string> _column_order_by_keys;
-    std::vector<JSONArray> _rows;
-    JSONObject _structure;
-    std::pair<std::string, std::string> _order_by{"id", "DESC"};
-    bool _is_auto_save_enabled = false;
-    bool _is_refresh_button_enabled = true;
-    bool _is_bookmarks_button_enabled = true;
-    bool _is_export_button_enabled = true;
-    bool _is_total_row_enabled = false;
-    int _limit = 20;
-    std::string _total_data_title;
-    JSONArray _total_data;
+    void EnsureColumns(const size_t count) {
+        while (_columns.size() < count) {
+            ColumnData column_data;
+            column_data.Resize(_rows_count);
+            _columns.push_back(std::move(column_data));
+        }
+    }
+
+    void FinishRow(const size_t cells_count) {
+        for (size_t i = cells_count; i < _columns.size(); ++i) {
+            _columns[i].Resize(_rows_count + 1);
+        }
+        ++_rows_count;
+    }
+
+    uint32_t Intern(const std::string_view value) {
+        const auto it = _string_codes.find(value);
+        if (it != _string_codes.end()) {
+            return it->second;
+        }
+
+        const auto code = static_cast<uint32_t>(_strings.size());
+        _strings.emplace_back(value);
+        _string_codes.emplace(std::string(value), code);
+        return code;
+    }
+
+    // Код строки в колонке ColumnType::String (общий пул builder'а) или ColumnType::Dictionary
+    // (словарь колонки)
+    uint32_t InternCell(ColumnData& column, const std::string_view value) {
+        if (column.type != ColumnType::Dictionary) {
+            return Intern(value);
+        }
+
+        const auto it = column.dictionary_codes.find(value);
+        if (it != column.dictionary_codes.end()) {
+            return it->second;
+        }
+
+        const auto code = static_cast<uint32_t>(column.dictionary.size());
+        column.dictionary.emplace_back(value);
+        column.dictionary_codes.emplace(std::string(value), code);
+        return code;
+    }
+
+    void AppendCell(ColumnData& column, const double value) {
+        switch (column.type) {
+            case ColumnType::Value: column.values.emplace_back(value); break;
+            case ColumnType::Double: column.doubles.push_back(value); break;
+            case ColumnType::Int64: column.integers.push_back(TruncateToInt64(value)); break;
+            case ColumnType::String:
+            case ColumnType::Dictionary: column.codes.push_back(InternCell(column, JSONNumberToString(value))); break;
+            case ColumnType::Decimal: column.integers.push_back(Decimal::Truncate(value, column.digits).units); break;
+        }
+    }
+
+    void AppendCell(ColumnData& column, const Decimal& value) {
+        switch (column.type) {
+            case ColumnType::Decimal: column.integers.push_back(Rescale(value, column.digits)); break;
+            case ColumnType::Int64: column.integers.push_back(value.Whole()); break;
+            case ColumnType::String:
+            case ColumnType::Dictionary: column.codes.push_back(InternCell(column, value.ToString())); break;
+            case ColumnType::Value:
+            case ColumnType::Double: AppendCell(column, value.ToDouble()); break;
+        }
+    }
+
+    void AppendCell(ColumnData& column, const int64_t value) {
+        switch (column.type) {
+            case ColumnType::Int64: column.integers.push_back(value); break;
+            case ColumnType::Value: column.values.emplace_back(value); break;
+            case ColumnType::String:
+            case ColumnType::Dictionary: column.codes.push_back(InternCell(column, std::to_string(value))); break;
+            case ColumnType::Decimal:
+            case ColumnType::Double: AppendCell(column, static_cast<double>(value)); break;
+        }
+    }
+
+    void AppendCell(ColumnData& column, const int value) { AppendCell(column, static_cast<int64_t>(value)); }
+
+    void AppendCell(ColumnData& column, const bool value) {
+        if (column.type == ColumnType::Value) {
+            column.values.emplace_back(value);
+        } else if (column.type == ColumnType::String || column.type == ColumnType::Dictionary) {
+            column.codes.push_back(InternCell(column, value ? "true" : "false"));
+        } else {
+            AppendCell(column, value ? 1.0 : 0.0);
+        }
+    }
+
+    void AppendCell(ColumnData& column, const std::string_view value) {
+        switch (column.type) {
+            case ColumnType::Value: column.values.emplace_back(std::string(value)); break;
+            case ColumnType::String:
+            case ColumnType::Dictionary: column.codes.push_back(InternCell(column, value)); break;
+            case ColumnType::Double: column.doubles.push_back(0.0); break;
+            case ColumnType::Int64:
+            case ColumnType::Decimal: column.integers.push_back(0); break;
+        }
+    }
+
+    void AppendCell(ColumnData& column, const std::string& value) { AppendCell(column, std::string_view(value)); }
+
+    void AppendCell(ColumnData& column, std::string&& value) {
+        if (column.type == ColumnType::Value) {
+            column.values.emplace_back(std::move(value));
+        } else {
+            AppendCell(column, std::string_view(value));
+        }
+    }
+
+    void AppendCell(ColumnData& column, const char* value) { AppendCell(column, std::string_view(value)); }
+
+    // Готовый код словаря; в колонку другого типа попадает значение по умолчанию
+    void AppendCell(ColumnData& column, const DictionaryCode value) {
+        if (column.type == ColumnType::Dictionary) {
+            column.codes.push_back(value.code);
+        } else {
+            AppendCell(column, std::string_view());
+        }
+    }
+
+    void AppendCell(ColumnData& column, const JSONValue& value) {
+        if (column.type == ColumnType::Value) {
+            column.values.push_back(value);
+            return;
+        }
+
+        std::visit([&](const auto& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, String>)
+                AppendCell(column, std::string_view(arg));
+            else if constexpr (std::is_same_v<T, double> || std::is_same_v<T, bool> || std::is_same_v<T, int64_t> ||
+                               std::is_same_v<T, Decimal>)
+                AppendCell(column, arg);
+            else
+                AppendCell(column, std::string_view());
+        }, value.value);
+    }
+
+    void AppendCell(ColumnData& column, JSONValue&& value) {
+        if (column.type == ColumnType::Value) {
+            column.values.push_back(std::move(value));
+        } else {
+            AppendCell(column, static_cast<const JSONValue&>(value));
+        }
+    }
+
+    [[nodiscard]] JSONValue GetCell(const ColumnData& column, const size_t row) const {
+        switch (column.type) {
+            case ColumnType::Value: return column.values[row];
+            case ColumnType::Double: return column.doubles[row];
+            case ColumnType::Int64: return column.integers[row];
+            case ColumnType::String: return _strings[column.codes[row]];
+            case ColumnType::Decimal: return Decimal{column.integers[row], column.digits}.ToDouble();
+            case ColumnType::Dictionary:
+                if (_is_dictionary_encoding_enabled) {
+                    return static_cast<int64_t>(column.codes[row]);
+                }
+                return column.dictionary[column.codes[row]];
+        }
+        return {};
+    }
+
+    void WriteCell(const ColumnData& column, const size_t row, Value& out, Document::AllocatorType& allocator) const {
+        switch (column.type) {
+            case ColumnType::Value: to_json_value(column.values[row], out, allocator); break;
+            case ColumnType::Double: out.SetDouble(column.doubles[row]); break;
+            case ColumnType::Int64: out.SetInt64(column.integers[row]); break;
+            case ColumnType::Decimal: out.SetDouble(Decimal{column.integers[row], column.digits}.ToDouble()); break;
+            case ColumnType::String: {
+                const std::string& value = _strings[column.codes[row]];
+                out.SetString(value.c_str(), static_cast<SizeType>(value.size()), allocator);
+                break;
+            }
+            case ColumnType::Dictionary: {
+                if (_is_dictionary_encoding_enabled) {
+                    out.SetInt64(column.codes[row]);
+                    break;
+                }
+                const std::string& value = column.dictionary[column.codes[row]];
+                out.SetString(value.c_str(), static_cast<SizeType>(value.size()), allocator);
+                break;
+            }
+        }
+    }
+
+    template <typename Handler>
+    bool StreamCell(const ColumnData& column, const size_t row, Handler& handler) const {
+        switch (column.type) {
+            case ColumnType::Value: return write_json_value(column.values[row], handler);
+            case ColumnType::Double: return handler.Double(column.doubles[row]);
+            case ColumnType::Int64: return handler.Int64(column.integers[row]);
+            case ColumnType::Decimal:
+                // Десятичный текст без double, байт в байт как у WriteCell
+                return write_json_decimal(Decimal{column.integers[row], column.digits}, handler);
+            case ColumnType::String: {
+                const std::string& value = _strings[column.codes[row]];
+                return handler.String(value.c_str(), static_cast<SizeType>(value.size()), true);
+            }
+            case ColumnType::Dictionary: {
+                if (_is_dictionary_encoding_enabled) {
+                    return handler.Int64(column.codes[row]);
+                }
+                const std::string& value = column.dictionary[column.codes[row]];
+                return handler.String(value.c_str(), static_cast<SizeType>(value.size()), true);
+            }
+        }
+        return handler.Null();
+    }
+
+    // data: {"rows": [...], "structure": [...]}; rows пишутся строка за строкой из колонок
+    template <typename Handler>
+    bool StreamData(const JSONObject& data_obj, Handler& handler) const {
+        if (!handler.StartObject()) {
+            return false;
+        }
+
+        for (const auto& [key, value] : data_obj) {
+            if (!handler.Key(key.c_str(), static_cast<SizeType>(key.size()), true)) {
+                return false;
+            }
+
+            if (key.str() != "rows") {
+                if (!write_json_value(value, handler)) {
+                    return false;
+                }
+                continue;
+            }
+
+            if (!handler.StartArray()) {
+                return false;
+            }
+            for (size_t row = 0; row < _rows_count; ++row) {
+                if (!handler.StartArray()) {
+                    return false;
+                }
+                for (const auto& column : _columns) {
+                    if (!StreamCell(column, row, handler)) {
+                        return false;
+                    }
+                }
+                if (!handler.EndArray(static_cast<SizeType>(_columns.size()))) {
+                    return false;
+                }
+            }
+            if (!handler.EndArray(static_cast<SizeType>(_rows_count))) {
+                return false;
+            }
+        }
+
+        return handler.EndObject(static_cast<SizeType>(data_obj.size()));
+    }
+
+    // Единицы value в масштабе колонки; лишние знаки отбрасываются
+    // Целая часть double для колонки Int64. Как и у Decimal::Truncate, NaN, бесконечности и
+    // значения вне диапазона int64 дают 0: static_cast для них - неопределенное поведение
+    static int64_t TruncateToInt64(const double value) {
+        if (!std::isfinite(value) || std::abs(value) >= 9.2e18) {
+            return 0;
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    static int64_t Rescale(const Decimal& value, const uint8_t digits) {
+        if (value.digits == digits) {
+            return value.units;
+        }
+        if (value.digits < digits) {
+            // Переполнение при умножении - тоже 0, как у значений вне диапазона
+            const int64_t scale = Decimal::kPow10[digits - value.digits];
+            if (value.units > INT64_MAX / scale || value.units < INT64_MIN / scale) {
+                return 0;
+            }
+            return value.units * scale;
+        }
+        return value.units / Decimal::kPow10[value.digits - digits];
+    }
+
+    static std::string JSONNumberToString(const double value) {
+        StringBuffer buffer;
+        Writer<StringBuffer> writer(buffer);
+        writer.Double(value);
+        return buffer.GetString();
+    }
 
     static JSONObject ConvertFilterToJson(const FilterConfig& filter_config) {
         JSONObject json_object;
@@ -1,5 +1,190 @@
 #include "PluginInterface.h"
 
+namespace {
+    // Закрывает общий интервал, добавляет трассу в статистику и, если в запросе есть
+    // флаг debug, кладёт её в ответ
+    void FinishTrace(ReportTrace&                        trace,
+                     ReportTrace::ScopedSpan&            total_span,
+                     const rapidjson::Value&             request,
+                     rapidjson::Value&                   response,
+                     rapidjson::Document::AllocatorType& allocator) {
+        total_span.Stop();
+        ReportMetrics::Instance().Add(trace);
+
+        if (!utils::IsFlagEnabled(request, "debug") || !response.IsObject()) {
+            return;
+        }
+
+        Value stages;
+        trace.WriteTo(stages, allocator);
+
+        Value debug(kObjectType);
+        debug.AddMember("stages", stages, allocator);
+        response.AddMember("debug", debug, allocator);
+    }
+
+    // Предел буфера арены, который поток хоста оставляет себе между запросами:
+    // MARGINCALL_ARENA_MAX_KB (1024 по умолчанию, 0 - не оставлять)
+    void ConfigureArena() {
+        static const bool configured = [] {
+            const size_t kilobytes = utils::EnvironmentValue(
+                "MARGINCALL_ARENA_MAX_KB", ScopedArena::MaxRetainedSize() / 1024);
+            ScopedArena::SetMaxRetainedSize(kilobytes * 1024);
+            return true;
+        }();
+        static_cast<void>(configured);
+    }
+
+    // Хост, который принимает готовую строку (флаг запроса __accept_serialized), получает ui
+    // одной JSON-строкой в response["ui_json"]. Дерево пишется SAX-событиями сразу в буфер из
+    // аллокатора ответа, без промежуточного rapidjson Document и без копии строки
+    template <typename WriteContent>
+    void WriteSerializedUI(rapidjson::Value&                   response,
+                           rapidjson::Document::AllocatorType& allocator,
+                           const size_t                        capacity,
+                           WriteContent&&                      write_content) {
+        // Free у пулового аллокатора ничего не делает: буфер остается жить вместе с ответом
+        static_assert(!rapidjson::Document::AllocatorType::kNeedFree);
+
+        using ResponseBuffer = GenericStringBuffer<UTF8<>, rapidjson::Document::AllocatorType>;
+
+        ResponseBuffer         buffer(&allocator, capacity);
+        Writer<ResponseBuffer> writer(buffer);
+        utils::WriteUI(writer, write_content);
+
+        const SizeType size = static_cast<SizeType>(buffer.GetSize());
+        response.SetObject();
+        response.AddMember("ui_json", Value(StringRef(buffer.GetString(), size)), allocator);
+    }
+
+    // Во что превращается ui ответа: rapidjson-значение (по умолчанию), готовая JSON-строка
+    // (__accept_serialized) или CBOR (__encoding: "cbor")
+    enum class UIEncoding { Value, SerializedJson, Cbor };
+
+    UIEncoding ParseUIEncoding(const rapidjson::Value& request) {
+        if (request.IsObject()) {
+            const auto it = request.FindMember("__encoding");
+            if (it != request.MemberEnd() && it->value.IsString() &&
+                std::strcmp(it->value.GetString(), "cbor") == 0) {
+                return UIEncoding::Cbor;
+            }
+        }
+        return utils::IsFlagEnabled(request, "__accept_serialized") ? UIEncoding::SerializedJson
+                                                                    : UIEncoding::Value;
+    }
+
+    // ui в CBOR (RFC 8949) теми же SAX-событиями, что и WriteSerializedUI. Ответ хоста - JSON,
+    // поэтому байты уходят в response["ui_cbor"] строкой base64, выделенной в аллокаторе ответа
+    void SetCborUI(rapidjson::Value&                   response,
+                   rapidjson::Document::AllocatorType& allocator,
+                   const std::string&                  cbor) {
+        const size_t size   = encoding::Base64Size(cbor.size());
+        auto*        base64 = static_cast<char*>(allocator.Malloc(size + 1));
+        encoding::Base64Encode(reinterpret_cast<const uint8_t*>(cbor.data()), cbor.size(), base64);
+        base64[size] = '\0';
+
+        response.SetObject();
+        response.AddMember(
+            "ui_cbor", Value(StringRef(base64, static_cast<SizeType>(size))), allocator);
+    }
+
+    // capacity - оценка размера JSON. Клиент, попросивший CBOR, получает ui_cbor всегда: после
+    // base64 он бывает длиннее JSON (encoding_bench), но выбор кодировки за клиентом
+    template <typename WriteContent>
+    void WriteEncodedUI(const UIEncoding                    ui_encoding,
+                        rapidjson::Value&                   response,
+                        rapidjson::Document::AllocatorType& allocator,
+                        const size_t                        capacity,
+                        WriteContent&&                      write_content) {
+        if (ui_encoding != UIEncoding::Cbor) {
+            WriteSerializedUI(response, allocator, capacity, write_content);
+            return;
+        }
+
+        std::string cbor;
+        cbor.reserve(capacity);
+
+        encoding::CborWriter writer(cbor);
+        utils::WriteUI(writer, write_content);
+
+        SetCborUI(response, allocator, cbor);
+    }
+
+    // Ответ без таблицы: заголовок, код и сообщение (отказ в доступе, ошибка выборки)
+    void WriteMessageUI(const char*                         title,
+                        const int                           code,
+                        const std::string&                  message,
+                        const UIEncoding                    ui_encoding,
+                        ReportTrace&                        trace,
+                        rapidjson::Value&                   response,
+                        rapidjson::Document::AllocatorType& allocator) {
+        const Node report =
+            div({h1({text(title)},
+                    props({{"style", JSONValue(JSONObject{{"color", JSONValue("#dc2626")}})}})),
+                 h2({text("Code: " + std::to_string(code))}),
+                 h2({text(message)},
+                    props({{"style", JSONValue(JSONObject{{"color", JSONValue("gray")}})}}))});
+
+        ReportTrace::ScopedSpan ui_span     = trace.Span(ReportStage::CreateUI);
+        const size_t            size_before = allocator.Size();
+        if (ui_encoding != UIEncoding::Value) {
+            WriteEncodedUI(ui_encoding, response, allocator, 1024, [&](auto& writer) {
+                return write_json(report, writer);
+            });
+        } else {
+            utils::CreateUI(report, response, allocator);
+        }
+        ui_span.SetBytes(allocator.Size() - size_before);
+    }
+
+    // Настройки и колонки таблицы не зависят от запроса: заготовка со структурой колонок в
+    // rapidjson собирается один раз за загрузку плагина, запрос работает с ее копией
+    const TableBuilder& MarginCallTableTemplate() {
+        static const TableBuilder table_template = [] {
+            // Заготовка живет дольше арены запроса, в котором ее впервые попросили
+            HeapScope heap;
+
+            TableBuilder table_builder("MarginCallReportTable");
+
+            // Main table props
+            table_builder.SetIdColumn("login");
+            table_builder.SetOrderBy("login", "DESC");
+            table_builder.EnableAutoSave(false);
+            table_builder.EnableRefreshButton(false);
+            table_builder.EnableBookmarksButton(false);
+            table_builder.EnableExportButton(true);
+            table_builder.EnableTotal(true);
+            table_builder.SetTotalDataTitle("TOTAL");
+
+            // Filters
+            FilterConfig search_filter;
+            search_filter.type = FilterType::Search;
+
+            // Columns
+            table_builder.AddColumn({"login", "LOGIN", 1, search_filter}, ColumnType::Int64);
+            table_builder.AddColumn({"name", "NAME", 2, search_filter}, ColumnType::String);
+            table_builder.AddColumn({"leverage", "LEVERAGE", 3, search_filter}, ColumnType::Int64);
+            table_builder.AddColumn({"balance", "BALANCE", 4, search_filter}, ColumnType::Decimal);
+            table_builder.AddColumn({"credit", "CREDIT", 5, search_filter}, ColumnType::Decimal);
+            table_builder.AddColumn({"floating_pl", "Floating P/L", 6, search_filter},
+                                    ColumnType::Decimal);
+            table_builder.AddColumn({"equity", "EQUITY", 7, search_filter}, ColumnType::Decimal);
+            table_builder.AddColumn({"margin", "MARGIN", 8, search_filter}, ColumnType::Decimal);
+            table_builder.AddColumn({"margin_free", "MARGIN_FREE", 9, search_filter},
+                                    ColumnType::Decimal);
+            table_builder.AddColumn({"margin_level", "MARGIN_LEVEL", 10, search_filter},
+                                    ColumnType::Decimal);
+            table_builder.AddColumn({"currency", "CURRENCY", 11, search_filter},
+                                    ColumnType::Dictionary);
+
+            table_builder.FreezeStructure();
+            return table_builder;
+        }();
+
+        return table_template;
+    }
+} // namespace
+
 extern "C" int GetReportApiVersion() {
     return ReportServerInterface::GetApiVersion();
 }
@@ -21,29 +206,156 @@ extern "C" void AboutReport(rapidjson::Value&                   request,
     response.AddMember("key", Value().SetString("MARGIN_CALL_REPORT", allocator), allocator);
 }
 
-extern "C" void DestroyReport() {}
+extern "C" void StatsReport(rapidjson::Value&                   request,
+                            rapidjson::Value&                   response,
+                            rapidjson::Document::AllocatorType& allocator,
+                            [[maybe_unused]] ReportServerInterface* server) {
+    ReportMetrics& metrics = ReportMetrics::Instance();
+
+    SnapshotCache&   snapshot_cache   = SnapshotCache::Instance();
+    RateCache&       rate_cache       = RateCache::Instance();
+    ValidationCache& validation_cache = ValidationCache::Instance();
+
+    metrics.WriteTo(response, allocator);
+
+    Value snapshot_cache_stats;
+    snapshot_cache.WriteTo(snapshot_cache_stats, allocator);
+    response.AddMember("snapshot_cache", snapshot_cache_stats, allocator);
+
+    Value rate_cache_stats;
+    rate_cache.WriteTo(rate_cache_stats, allocator);
+    response.AddMember("rate_cache", rate_cache_stats, allocator);
+
+    Value validation_cache_stats;
+    validation_cache.WriteTo(validation_cache_stats, allocator);
+    response.AddMember("validation_cache", validation_cache_stats, allocator);
+
+    if (utils::IsFlagEnabled(request, "reset")) {
+        metrics.Reset();
+        snapshot_cache.ResetCounters();
+        rate_cache.ResetCounters();
+        validation_cache.ResetCounters();
+    }
+}
+
+extern "C" void EventReport(rapidjson::Value&                   request,
+                            rapidjson::Value&                   response,
+                            rapidjson::Document::AllocatorType& allocator,
+                            ReportServerInterface*              server) {
+    MarginCallSet& margin_call_set = MarginCallSet::Instance();
+
+    // {"reset": true} выключает набор; любой другой вызов (даже без событий) включает его
+    const bool reset = utils::IsFlagEnabled(request, "reset");
+    if (reset) {
+        margin_call_set.Reset();
+    }
+
+    std::vector<ReportEvent> events;
+    EventsResult             result;
+
+    if (request.IsObject() && request.HasMember("events") && request["events"].IsArray()) {
+        const auto& events_array = request["events"].GetArray();
+        events.reserve(events_array.Size());
+
+        for (const auto& event_value : events_array) {
+            if (!event_value.IsObject() || !event_value.HasMember("type") ||
+                !event_value["type"].IsInt()) {
+                ++result.ignored;
+                continue;
+            }
+
+            ReportEvent event;
+            event.type = static_cast<EventType>(event_value["type"].GetInt());
+            if (event_value.HasMember("record") && event_value["record"].IsInt()) {
+                event.record = static_cast<EventRecordType>(event_value["record"].GetInt());
+            }
+            if (event_value.HasMember("login") && event_value["login"].IsInt()) {
+                event.login = event_value["login"].GetInt();
+            }
+            events.push_back(event);
+        }
+    }
+
+    // Конфигурация групп изменилась: запомненные проверки доступа больше не действительны
+    for (const ReportEvent& event : events) {
+        if (event.type == EV_TYPE_GROUP) {
+            ValidationCache::Instance().Clear();
+            break;
+        }
+    }
+
+    if (server != nullptr && (!reset || !events.empty())) {
+        const EventsResult applied = margin_call_set.Apply(events, server);
+        result.applied += applied.applied;
+        result.ignored += applied.ignored;
+    }
+
+    response.SetObject();
+    response.AddMember("applied", static_cast<uint64_t>(result.applied), allocator);
+    response.AddMember("ignored", static_cast<uint64_t>(result.ignored), allocator);
+    response.AddMember("active", margin_call_set.Active(), allocator);
+    response.AddMember("seeded", margin_call_set.Seeded(), allocator);
+    response.AddMember("views", static_cast<uint64_t>(margin_call_set.Views()), allocator);
+    response.AddMember("rows", static_cast<uint64_t>(margin_call_set.Size()), allocator);
+    response.AddMember("version", margin_call_set.Version(), allocator);
+}
+
+extern "C" void DestroyReport() {
+    MarginCallSet::Instance().Reset();
+    SnapshotCache::Instance().Clear();
+    RateCache::Instance().Clear();
+    ValidationCache::Instance().Clear();
+    Executor::Instance().Shutdown();
+    ScopedArena::ReleaseRetained();
+    // Деревья запросов и кэши уже разрушены: их ключи больше не нужны
+    JSONKey::ReleaseRequestKeys();
+}
 
 extern "C" void CreateReport(rapidjson::Value&                   request,
                              rapidjson::Value&                   response,
                              rapidjson::Document::AllocatorType& allocator,
                              ReportServerInterface*              server) {
+    // Все ast-объекты запроса живут в одной арене и освобождаются разом при выходе; она
+    // объявлена первой, чтобы разрушиться последней
+    ConfigureArena();
+    ScopedArena arena;
+
+    ReportTrace             trace;
+    ReportTrace::ScopedSpan total_span = trace.Span(ReportStage::Total);
+
+    const UIEncoding ui_encoding = ParseUIEncoding(request);
+
+    // Capture: ответы сервера дописываются в файл для воспроизведения в margincall_bench --replay
+    std::unique_ptr<RecordingReportServer> recorder;
+    if (const char* capture_file = std::getenv("MARGINCALL_CAPTURE_FILE");
+        capture_file != nullptr && *capture_file != '\0') {
+        try {
+            recorder = std::make_unique<RecordingReportServer>(server, capture_file);
+            server   = recorder.get();
+        } catch (const std::exception& e) {
+            std::cerr << "[MarginCallReportInterface]: " << e.what() << std::endl;
+        }
+    }
+
     // Validation
-    constexpr ReportType   report_type = ReportType::Group;
-    const ValidationResult validation_result =
+    constexpr ReportType    report_type = ReportType::Group;
+    ReportTrace::ScopedSpan validation_span = trace.Span(ReportStage::Validation);
+    const ValidationResult  validation_result =
         RequestValidator::ValidateRequest(report_type, request, server);
+    validation_span.Stop();
 
     if (!validation_result.allowed) {
         std::cerr << "[MarginCallReportInterface]: " << validation_result.code
                   << ", message: " << validation_result.message << std::endl;
 
-        const Node report =
-            div({h1({text("Access Denied")},
-                    props({{"style", JSONValue(JSONObject{{"color", JSONValue("#dc2626")}})}})),
-                 h2({text("Code: " + std::to_string(validation_result.code))}),
-                 h2({text(validation_result.message)},
-                    props({{"style", JSONValue(JSONObject{{"color", JSONValue("gray")}})}}))});
-
-        utils::CreateUI(report, response, allocator);
+        WriteMessageUI("Access Denied",
+                       validation_result.code,
+                       validation_result.message,
+                       ui_encoding,
+                       trace,
+                       response,
+                       allocator);
+        FinishTrace(trace, total_span, request, response, allocator);
 
         return;
     }
@@ -57,120 +369,344 @@ extern "C" void CreateReport(rapidjson::Value&                   request,
     std::string group_mask =
         requested_group_mask == "*" ? allowed_group_mask : requested_group_mask;
 
-    std::unordered_map<std::string, Total>     totals_map;
-    std::vector<ReportAccountRecord>           accounts_vector;
-    std::vector<ReportGroupRecord>             groups_vector;
-    std::unordered_map<int, ReportMarginLevel> margins_map;
+    // Индекс групп и отфильтрованный набор margin call: из набора, который ведется по событиям
+    // (EventReport), из кэша снимков (MARGINCALL_SNAPSHOT_TTL_MS) или свежей выборкой.
+    // Кэшируются только полностью загруженные снимки
+    std::shared_ptr<const ReportSnapshot> snapshot;
 
-    try {
-        std::vector<ReportMarginLevel> margins_tmp_vector;
+    // Строки набора и, если клиент прислал "since_version" из прошлого ответа, их изменения
+    MarginCallSelection set_selection;
+    bool                from_set = false;
 
-        server->GetAccountsByGroup(group_mask, &accounts_vector);
-        server->GetAllGroups(&groups_vector);
-        server->GetMarginLevelByGroup(group_mask, &margins_tmp_vector);
+    if (MarginCallSet::Instance().Active()) {
+        MarginCallSet& margin_call_set = MarginCallSet::Instance();
+        auto           live            = std::make_shared<ReportSnapshot>();
 
-        for (const auto& margin_level : margins_tmp_vector) {
-            margins_map[margin_level.login] = margin_level;
+        std::optional<uint64_t> since;
+        if (request.HasMember("since_version") && request["since_version"].IsString()) {
+            since = margin_call_set.ParseVersionToken(request["since_version"].GetString());
         }
 
-    } catch (const std::exception& e) {
-        std::cerr << "[MarginCallReportInterface]: " << e.what() << std::endl;
+        ReportTrace::ScopedSpan join_span = trace.Span(ReportStage::JoinFilter);
+        if (margin_call_set.Select(group_mask, server, set_selection, since)) {
+            live->query_result.entries = std::move(set_selection.entries);
+            join_span.SetRows(live->query_result.entries.size());
+            join_span.Stop();
+
+            ReportTrace::ScopedSpan groups_span = trace.Span(ReportStage::FetchGroups);
+            std::vector<ReportGroupRecord> groups;
+            try {
+                server->GetAllGroups(&groups);
+            } catch (const std::exception& e) {
+                std::cerr << "[MarginCallReportInterface]: GetAllGroups: " << e.what()
+                          << std::endl;
+            }
+            groups_span.SetRows(groups.size());
+            groups_span.Stop();
+
+            live->group_index.Build(groups);
+            live->query_result.scanned_rows = live->query_result.entries.size();
+            snapshot = std::move(live);
+            from_set = true;
+
+            std::cout << "[MarginCallReportInterface]: margin call set, rows: "
+                      << snapshot->query_result.entries.size()
+                      << ", version: " << set_selection.version;
+            if (set_selection.delta) {
+                std::cout << ", changed: " << set_selection.changed.size()
+                          << ", removed: " << set_selection.removed.size();
+            }
+            std::cout << std::endl;
+        }
     }
 
+    if (snapshot == nullptr) {
+        snapshot = SnapshotCache::Instance().Find(group_mask);
+
+        if (snapshot != nullptr) {
+            std::cout << "[MarginCallReportInterface]: snapshot cache hit, rows: "
+                      << snapshot->query_result.entries.size() << std::endl;
+        }
+    }
+
+    if (snapshot == nullptr) {
+        auto fresh = std::make_shared<ReportSnapshot>();
+
+        try {
+            const bool       prefetch = QueryPlanner::ShouldPrefetchAccounts(group_mask);
+            FetchStageResult fetched  = DataFetcher::Fetch(group_mask, server, prefetch);
+            DataFetcher::LogLatencies(fetched);
+            DataFetcher::RecordSpans(fetched, trace);
+
+            fresh->group_index.Build(fetched.groups.rows);
+
+            if (!fetched.margins.ok) {
+                throw std::runtime_error("GetMarginLevelByGroup: " + fetched.margins.error);
+            }
+
+            ReportTrace::ScopedSpan join_span = trace.Span(ReportStage::JoinFilter);
+            fresh->query_result =
+                QueryPlanner::Execute(std::move(fetched.margins.rows),
+                                      fetched.accounts.ok ? &fetched.accounts.rows : nullptr,
+                                      group_mask,
+                                      server);
+            join_span.SetRows(fresh->query_result.entries.size());
+            join_span.Stop();
+
+            const QueryPlanResult& query_result = fresh->query_result;
+            QueryPlanner::Remember(group_mask, query_result);
+            std::cout << "[MarginCallReportInterface]: plan: "
+                      << QueryPlanner::PlanName(query_result.plan)
+                      << ", selectivity: " << query_result.selectivity
+                      << ", rows: " << query_result.entries.size() << "/"
+                      << query_result.scanned_rows << std::endl;
+
+            // Без групп у всех строк валюта N/A: такой снимок не кэшируется
+            if (fetched.groups.ok) {
+                SnapshotCache::Instance().Insert(group_mask, fresh);
+            }
+        } catch (const std::exception& e) {
+            // Пустая таблица выглядела бы как "нет margin call": клиент получает ошибку
+            std::cerr << "[MarginCallReportInterface]: " << e.what() << std::endl;
+
+            WriteMessageUI("Report Error", 500, e.what(), ui_encoding, trace, response, allocator);
+            FinishTrace(trace, total_span, request, response, allocator);
+
+            return;
+        }
+
+        snapshot = std::move(fresh);
+    }
+
+    const GroupIndex& group_index = snapshot->group_index;
+
     // Main table
-    TableBuilder table_builder("MarginCallReportTable");
-
-    // Main table props
-    table_builder.SetIdColumn("login");
-    table_builder.SetOrderBy("login", "DESC");
-    table_builder.EnableAutoSave(false);
-    table_builder.EnableRefreshButton(false);
-    table_builder.EnableBookmarksButton(false);
-    table_builder.EnableExportButton(true);
-    table_builder.EnableTotal(true);
-    table_builder.SetTotalDataTitle("TOTAL");
-
-    // Filters
-    FilterConfig search_filter;
-    search_filter.type = FilterType::Search;
-
-    // Columns
-    table_builder.AddColumn({"login", "LOGIN", 1, search_filter});
-    table_builder.AddColumn({"name", "NAME", 2, search_filter});
-    table_builder.AddColumn({"leverage", "LEVERAGE", 3, search_filter});
-    table_builder.AddColumn({"balance", "BALANCE", 4, search_filter});
-    table_builder.AddColumn({"credit", "CREDIT", 5, search_filter});
-    table_builder.AddColumn({"floating_pl", "Floating P/L", 6, search_filter});
-    table_builder.AddColumn({"equity", "EQUITY", 7, search_filter});
-    table_builder.AddColumn({"margin", "MARGIN", 8, search_filter});
-    table_builder.AddColumn({"margin_free", "MARGIN_FREE", 9, search_filter});
-    table_builder.AddColumn({"margin_level", "MARGIN_LEVEL", 10, search_filter});
-    table_builder.AddColumn({"currency", "CURRENCY", 11, search_filter});
-
-    for (const auto& account : accounts_vector) {
-        std::vector<ReportTradeRecord> trades_vector;
-        double                         floating_pl  = 0.0;
-        ReportMarginLevel              margin_level = margins_map[account.login];
-
-        if (margin_level.level_type == MARGINLEVEL_MARGINCALL ||
-            margin_level.level_type == MARGINLEVEL_STOPOUT) {
-
-            double      multiplier = 1;
-            std::string currency   = utils::GetGroupCurrencyByName(groups_vector, account.group);
-
-            // Conversion disabled
-            // if (currency != "USD") {
-            //     try {
-            //         server->CalculateConvertRateByCurrency(
-            //             currency, "USD", static_cast<int>(ReportTradeCommand::Sell),
-            //             &multiplier);
-            //     } catch (const std::exception& e) {
-            //         std::cerr << "[MarginCallReportInterface]: " << e.what() << std::endl;
-            //     }
-            // }
-
-            floating_pl = margin_level.equity - margin_level.balance;
-
-            totals_map[currency].balance += margin_level.balance * multiplier;
-            totals_map[currency].credit += margin_level.credit * multiplier;
-            totals_map[currency].floating_pl += floating_pl * multiplier;
-            totals_map[currency].equity += margin_level.equity * multiplier;
-            totals_map[currency].margin += margin_level.margin * multiplier;
-            totals_map[currency].margin_free += margin_level.margin_free * multiplier;
-
-            table_builder.AddRow({utils::TruncateDouble(account.login, 0),
-                                  account.name,
-                                  utils::TruncateDouble(margin_level.leverage, 0),
-                                  utils::TruncateDouble(margin_level.balance * multiplier, 2),
-                                  utils::TruncateDouble(margin_level.credit * multiplier, 2),
-                                  utils::TruncateDouble(floating_pl * multiplier, 2),
-                                  utils::TruncateDouble(margin_level.equity * multiplier, 2),
-                                  utils::TruncateDouble(margin_level.margin * multiplier, 2),
-                                  utils::TruncateDouble(margin_level.margin_free * multiplier, 2),
-                                  utils::TruncateDouble(margin_level.margin_level, 2),
-                                  currency});
+    ReportTrace::ScopedSpan table_span = trace.Span(ReportStage::TableBuild);
+    TableBuilder            table_builder = MarginCallTableTemplate();
+
+    // Totals by currency id over the full margin call set, in the order currencies first appear
+    const std::vector<MarginCallEntry>& entries = snapshot->query_result.entries;
+
+    std::vector<Total>      totals(group_index.CurrenciesCount());
+    std::vector<bool>       totals_used(group_index.CurrenciesCount(), false);
+    std::vector<CurrencyId> totals_order;
+    std::vector<CurrencyId> currency_ids(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const ReportMarginLevel& margin_level = entries[i].margin;
+
+        const CurrencyId currency_id = group_index.GetCurrencyId(margin_level.group);
+        const double     floating_pl = margin_level.equity - margin_level.balance;
+
+        currency_ids[i] = currency_id;
+
+        if (!totals_used[currency_id]) {
+            totals_used[currency_id] = true;
+            totals_order.push_back(currency_id);
+        }
+
+        // Суммы в валюте группы. Это и есть проход по денежным столбцам: курс одинаков для всех
+        // строк валюты, поэтому в USD переводятся готовые итоги (sum(rate * x) = rate * sum(x)),
+        // а не каждая строка
+        Total& total = totals[currency_id];
+        total.balance += margin_level.balance;
+        total.credit += margin_level.credit;
+        total.floating_pl += floating_pl;
+        total.equity += margin_level.equity;
+        total.margin += margin_level.margin;
+        total.margin_free += margin_level.margin_free;
+    }
+
+    // Paging: only the requested window of rows is sorted and serialized
+    const PageRequest page_request = Paginator::Parse(request);
+
+    // Дельта: только добавленные и измененные строки, итоги по всему набору. Для страниц и
+    // слишком старого токена - полная таблица
+    const bool delta = from_set && set_selection.delta && !page_request.enabled;
+
+    PageResult page;
+    if (delta) {
+        page.positions = std::move(set_selection.changed);
+        page.total     = entries.size();
+    } else {
+        page = Paginator::SelectPage(entries, currency_ids, group_index, page_request);
+    }
+
+    if (from_set) {
+        MarginCallSet& margin_call_set = MarginCallSet::Instance();
+        table_builder.SetVersion(margin_call_set.VersionToken(set_selection.version));
+
+        if (delta) {
+            TableDelta table_delta;
+            table_delta.since = request["since_version"].GetString();
+            table_delta.removed.assign(set_selection.removed.begin(), set_selection.removed.end());
+            table_builder.SetDelta(std::move(table_delta));
         }
     }
 
+    if (page_request.enabled) {
+        table_builder.SetOrderBy(Paginator::ColumnKey(page_request.column),
+                                 page_request.descending ? "DESC" : "ASC");
+        // Parse ограничивает limit значением Paginator::kMaxLimit: в int помещается
+        table_builder.SetLimit(static_cast<int>(page_request.limit));
+        table_builder.SetPagination(
+            {page.total, page.offset, page_request.limit, page.has_more, page.next_cursor});
+    }
+
+    // Rows are stored column by column and written into the response allocator at the end.
+    // Currencies are already interned by GroupIndex in the totals loop: the currency column takes
+    // its dictionary from there and rows carry CurrencyId codes. A client that understands
+    // data.dictionaries asks for the codes themselves with __dictionary_encoding
+    table_builder.SetDictionary("currency", group_index.Currencies());
+    table_builder.EnableDictionaryEncoding(utils::IsFlagEnabled(request, "__dictionary_encoding"));
+    table_builder.ReserveRows(page.positions.size());
+
+    for (const uint32_t position : page.positions) {
+        const auto& [margin_level, name] = entries[position];
+        const double floating_pl         = margin_level.equity - margin_level.balance;
+
+        table_builder.AppendRow(margin_level.login,
+                                name,
+                                margin_level.leverage,
+                                Decimal::Truncate(margin_level.balance, 2),
+                                Decimal::Truncate(margin_level.credit, 2),
+                                Decimal::Truncate(floating_pl, 2),
+                                Decimal::Truncate(margin_level.equity, 2),
+                                Decimal::Truncate(margin_level.margin, 2),
+                                Decimal::Truncate(margin_level.margin_free, 2),
+                                Decimal::Truncate(margin_level.margin_level, 2),
+                                DictionaryCode{currency_ids[position]});
+    }
+
     // Total row
     JSONArray totals_array;
-    for (const auto& [currency, total] : totals_map) {
+    for (const CurrencyId currency_id : totals_order) {
+        const Total&       total    = totals[currency_id];
+        const std::string& currency = group_index.GetCurrencyName(currency_id);
+
         totals_array.emplace_back(
-            JSONObject{{"balance", utils::TruncateDouble(total.balance, 2)},
-                       {"credit", utils::TruncateDouble(total.credit, 2)},
-                       {"equity", utils::TruncateDouble(total.equity, 2)},
-                       {"floating_pl", utils::TruncateDouble(total.floating_pl, 2)},
-                       {"margin", utils::TruncateDouble(total.margin, 2)},
-                       {"margin_free", utils::TruncateDouble(total.margin_free, 2)},
+            JSONObject{{"balance", Decimal::Truncate(total.balance, 2)},
+                       {"credit", Decimal::Truncate(total.credit, 2)},
+                       {"equity", Decimal::Truncate(total.equity, 2)},
+                       {"floating_pl", Decimal::Truncate(total.floating_pl, 2)},
+                       {"margin", Decimal::Truncate(total.margin, 2)},
+                       {"margin_free", Decimal::Truncate(total.margin_free, 2)},
                        {"currency", currency}});
     }
 
-    table_builder.SetTotalData(totals_array);
+    // USD-consolidated total: one conversion rate per currency of the totals (RateCache), so the
+    // cost does not depend on the number of rows. Currencies without a rate, and N/A, are left
+    // out and listed in "unconverted"
+    if (utils::IsFlagEnabled(request, "__usd_total")) {
+        Total     usd_total;
+        JSONArray unconverted;
 
-    const JSONObject table_props = table_builder.CreateTableProps();
-    const Node       table_node  = Table({}, table_props);
+        std::vector<CurrencyId>  currency_ids_to_convert;
+        std::vector<std::string> currencies;
+        for (const CurrencyId currency_id : totals_order) {
+            if (currency_id == GroupIndex::kUnknownCurrency) {
+                unconverted.emplace_back(GroupIndex::kUnknownCurrencyName);
+                continue;
+            }
+            currency_ids_to_convert.push_back(currency_id);
+            currencies.push_back(group_index.GetCurrencyName(currency_id));
+        }
+
+        const std::vector<std::optional<double>> rates = RateCache::Instance().Resolve(
+            currencies, "USD", static_cast<int>(ReportTradeCommand::Sell), server);
+
+        for (size_t i = 0; i < currencies.size(); ++i) {
+            if (!rates[i]) {
+                unconverted.emplace_back(currencies[i]);
+                continue;
+            }
+
+            const Total& total = totals[currency_ids_to_convert[i]];
+            const double rate  = *rates[i];
+            usd_total.balance += total.balance * rate;
+            usd_total.credit += total.credit * rate;
+            usd_total.floating_pl += total.floating_pl * rate;
+            usd_total.equity += total.equity * rate;
+            usd_total.margin += total.margin * rate;
+            usd_total.margin_free += total.margin_free * rate;
+        }
 
-    const Node report = Column({h1({text("Margin Call Report")}), table_node});
+        totals_array.emplace_back(
+            JSONObject{{"balance", Decimal::Truncate(usd_total.balance, 2)},
+                       {"credit", Decimal::Truncate(usd_total.credit, 2)},
+                       {"equity", Decimal::Truncate(usd_total.equity, 2)},
+                       {"floating_pl", Decimal::Truncate(usd_total.floating_pl, 2)},
+                       {"margin", Decimal::Truncate(usd_total.margin, 2)},
+                       {"margin_free", Decimal::Truncate(usd_total.margin_free, 2)},
+                       {"currency", "USD"},
+                       {"consolidated", true},
+                       {"unconverted", std::move(unconverted)}});
+    }
+
+    table_builder.SetTotalData(std::move(totals_array));
+
+    table_span.SetRows(table_builder.RowsCount());
+    table_span.Stop();
+
+    if (ui_encoding != UIEncoding::Value) {
+        ReportTrace::ScopedSpan json_span   = trace.Span(ReportStage::JsonConversion);
+        const size_t            json_before = allocator.Size();
+
+        // Грубая оценка: ~160 байт на строку таблицы плюс шапка, структура и итоги
+        const size_t capacity = table_builder.RowsCount() * 160 + 16 * 1024;
+
+        WriteEncodedUI(ui_encoding, response, allocator, capacity, [&](auto& writer) {
+            // Column { h1, Table { props } } - как в ветке с rapidjson Document ниже
+            return writer.StartObject() &&
+                   writer.Key("type", 4, false) &&
+                   writer.String("Column", 6, false) &&
+                   writer.Key("children", 8, false) &&
+                   writer.StartArray() &&
+                   write_json(h1({text("Margin Call Report")}), writer) &&
+                   writer.StartObject() &&
+                   writer.Key("type", 4, false) &&
+                   writer.String("Table", 5, false) &&
+                   writer.Key("props", 5, false) &&
+                   table_builder.StreamTableProps(writer) &&
+                   writer.EndObject(2) &&
+                   writer.EndArray(2) &&
+                   writer.EndObject(2);
+        });
+
+        json_span.SetRows(table_builder.RowsCount());
+        json_span.SetBytes(allocator.Size() - json_before);
+        json_span.Stop();
+
+        total_span.SetRows(table_builder.RowsCount());
+        FinishTrace(trace, total_span, request, response, allocator);
+        return;
+    }
+
+    ReportTrace::ScopedSpan json_span   = trace.Span(ReportStage::JsonConversion);
+    const size_t            json_before = allocator.Size();
+
+    Value table_props(kObjectType);
+    table_builder.WriteTableProps(table_props, allocator);
+
+    Value table_object(kObjectType);
+    table_object.AddMember("type", "Table", allocator);
+    table_object.AddMember("props", table_props, allocator);
+
+    Value report_object;
+    to_json(Column({h1({text("Margin Call Report")})}), report_object, allocator);
+    report_object["children"].PushBack(table_object, allocator);
+
+    json_span.SetRows(table_builder.RowsCount());
+    json_span.SetBytes(allocator.Size() - json_before);
+    json_span.Stop();
+
+    {
+        ReportTrace::ScopedSpan ui_span     = trace.Span(ReportStage::CreateUI);
+        const size_t            size_before = allocator.Size();
+        utils::CreateUI(report_object, response, allocator);
+        ui_span.SetBytes(allocator.Size() - size_before);
+    }
 
-    utils::CreateUI(report, response, allocator);
+    total_span.SetRows(table_builder.RowsCount());
+    FinishTrace(trace, total_span, request, response, allocator);
 }
\ No newline at end of file
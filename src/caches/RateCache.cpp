@@ -0,0 +1,124 @@
+#include "RateCache.h"
+
+#include <exception>
+#include <iostream>
+
+#include "Structures.h"
+#include "utils/Utils.h"
+
+using rapidjson::Value;
+
+RateCache& RateCache::Instance() {
+    static RateCache cache;
+    return cache;
+}
+
+RateCache::RateCache() {
+    _ttl = std::chrono::milliseconds(utils::EnvironmentValue("MARGINCALL_RATE_TTL_MS", 0));
+}
+
+void RateCache::Configure(const std::chrono::milliseconds ttl) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _ttl = ttl;
+    _entries.clear();
+}
+
+std::vector<std::optional<double>> RateCache::Resolve(const std::vector<std::string>& from,
+                                                      const std::string&              to,
+                                                      const int                       cmd,
+                                                      ReportServerInterface*          server) {
+    std::vector<std::optional<double>> rates(from.size());
+    std::vector<size_t>                missing;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const Clock::time_point     now = Clock::now();
+
+        for (size_t i = 0; i < from.size(); ++i) {
+            if (from[i] == to) {
+                rates[i] = 1.0;
+                continue;
+            }
+
+            if (_ttl.count() > 0) {
+                const auto it = _entries.find(Key(from[i], to, cmd));
+                if (it != _entries.end() && now - it->second.created < _ttl) {
+                    rates[i] = it->second.rate;
+                    ++_hits;
+                    continue;
+                }
+            }
+
+            missing.push_back(i);
+        }
+        _misses += missing.size();
+    }
+
+    if (missing.empty()) {
+        return rates;
+    }
+
+    // Вызовы сервера - без блокировки, параллельные запросы могут запросить одну валюту дважды
+    size_t errors = 0;
+    for (const size_t i : missing) {
+        double multiplier = 0.0;
+        try {
+            if (server->CalculateConvertRateByCurrency(from[i], to, cmd, &multiplier) == RET_OK) {
+                rates[i] = multiplier;
+            } else {
+                ++errors;
+            }
+        } catch (const std::exception& e) {
+            ++errors;
+            std::cerr << "[MarginCallReportInterface]: CalculateConvertRateByCurrency(" << from[i]
+                      << ", " << to << "): " << e.what() << std::endl;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _errors += errors;
+
+    if (_ttl.count() > 0) {
+        const Clock::time_point now = Clock::now();
+        for (const size_t i : missing) {
+            if (rates[i]) {
+                _entries[Key(from[i], to, cmd)] = Entry{*rates[i], now};
+            }
+        }
+    }
+
+    return rates;
+}
+
+void RateCache::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+void RateCache::WriteTo(Value& out, rapidjson::Document::AllocatorType& allocator) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    out.SetObject();
+    out.AddMember("enabled", _ttl.count() > 0, allocator);
+    out.AddMember("ttl_ms", static_cast<int64_t>(_ttl.count()), allocator);
+    out.AddMember("entries", static_cast<uint64_t>(_entries.size()), allocator);
+    out.AddMember("hits", _hits, allocator);
+    out.AddMember("misses", _misses, allocator);
+    out.AddMember("errors", _errors, allocator);
+}
+
+void RateCache::ResetCounters() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hits   = 0;
+    _misses = 0;
+    _errors = 0;
+}
+
+std::string RateCache::Key(const std::string& from, const std::string& to, const int cmd) {
+    std::string key;
+    key.reserve(from.size() + to.size() + 8);
+    key.append(from).push_back('\0');
+    key.append(to).push_back('\0');
+    key.append(std::to_string(cmd));
+    return key;
+}
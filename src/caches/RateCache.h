@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ReportServerInterface.h"
+#include "rapidjson/document.h"
+
+// Conversion rates of CalculateConvertRateByCurrency keyed by (from, to, cmd), so converting
+// report totals costs one server call per distinct currency rather than one per account row.
+//
+// Resolve() takes the distinct currencies of a request and asks the server only for those it
+// does not hold. With MARGINCALL_RATE_TTL_MS (0 - the default) resolved rates are also kept
+// across requests for that long; otherwise every request resolves its currencies anew.
+class RateCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static RateCache& Instance();
+
+    void Configure(std::chrono::milliseconds ttl);
+
+    // Курсы from[i] -> to; nullopt - сервер не вернул курс (валюта не входит в итог)
+    std::vector<std::optional<double>> Resolve(const std::vector<std::string>& from,
+                                               const std::string&              to,
+                                               int                             cmd,
+                                               ReportServerInterface*          server);
+
+    void Clear();
+
+    // {"enabled", "ttl_ms", "entries", "hits", "misses", "errors"}
+    void WriteTo(rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) const;
+
+    void ResetCounters();
+
+private:
+    struct Entry {
+        double            rate = 1.0;
+        Clock::time_point created;
+    };
+
+    RateCache();
+
+    static std::string Key(const std::string& from, const std::string& to, int cmd);
+
+    mutable std::mutex                     _mutex;
+    std::chrono::milliseconds              _ttl{0};
+    std::unordered_map<std::string, Entry> _entries;
+    uint64_t                               _hits   = 0;
+    uint64_t                               _misses = 0;
+    uint64_t                               _errors = 0;
+};
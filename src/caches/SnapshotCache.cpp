@@ -0,0 +1,161 @@
+#include "SnapshotCache.h"
+
+#include "utils/Utils.h"
+
+using rapidjson::Value;
+
+namespace {
+    size_t StringBytes(const std::string& value) {
+        return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+    }
+} // namespace
+
+SnapshotCache& SnapshotCache::Instance() {
+    static SnapshotCache cache;
+    return cache;
+}
+
+SnapshotCache::SnapshotCache() {
+    const size_t ttl_ms = utils::EnvironmentValue("MARGINCALL_SNAPSHOT_TTL_MS", 0);
+    const size_t max_mb = utils::EnvironmentValue("MARGINCALL_SNAPSHOT_MAX_MB", 0);
+
+    _ttl       = std::chrono::milliseconds(ttl_ms);
+    _max_bytes = max_mb == 0 ? kDefaultMaxBytes : max_mb * 1024 * 1024;
+}
+
+void SnapshotCache::Configure(const std::chrono::milliseconds ttl, const size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _ttl       = ttl;
+    _max_bytes = max_bytes;
+
+    // Новые ограничения действуют и на уже лежащие снимки
+    EvictExpiredLocked(Clock::now());
+    while (_bytes > _max_bytes && !_entries.empty()) {
+        EvictOldestLocked();
+    }
+}
+
+bool SnapshotCache::Enabled() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _ttl.count() > 0;
+}
+
+std::shared_ptr<const ReportSnapshot> SnapshotCache::Find(const std::string& group_mask) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ttl.count() <= 0) {
+        return nullptr;
+    }
+
+    const auto it = _entries.find(group_mask);
+    if (it == _entries.end()) {
+        ++_misses;
+        return nullptr;
+    }
+
+    if (Clock::now() - it->second.created >= _ttl) {
+        EraseLocked(it);
+        ++_misses;
+        return nullptr;
+    }
+
+    ++_hits;
+    return it->second.snapshot;
+}
+
+void SnapshotCache::Insert(const std::string&                    group_mask,
+                           std::shared_ptr<const ReportSnapshot> snapshot) {
+    if (snapshot == nullptr) {
+        return;
+    }
+
+    // Оценка без блокировки: снимок уже не меняется
+    const size_t bytes = EstimateBytes(*snapshot) + group_mask.size();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ttl.count() <= 0 || bytes > _max_bytes) {
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    EvictExpiredLocked(now);
+
+    if (const auto it = _entries.find(group_mask); it != _entries.end()) {
+        _bytes -= it->second.bytes;
+        _entries.erase(it);
+    }
+
+    while (_bytes + bytes > _max_bytes && !_entries.empty()) {
+        EvictOldestLocked();
+    }
+
+    _entries.emplace(group_mask, Entry{std::move(snapshot), now, bytes});
+    _bytes += bytes;
+}
+
+void SnapshotCache::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _bytes = 0;
+}
+
+void SnapshotCache::WriteTo(Value& out, rapidjson::Document::AllocatorType& allocator) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    out.SetObject();
+    out.AddMember("enabled", _ttl.count() > 0, allocator);
+    out.AddMember("ttl_ms", static_cast<int64_t>(_ttl.count()), allocator);
+    out.AddMember("max_bytes", static_cast<uint64_t>(_max_bytes), allocator);
+    out.AddMember("entries", static_cast<uint64_t>(_entries.size()), allocator);
+    out.AddMember("bytes", static_cast<uint64_t>(_bytes), allocator);
+    out.AddMember("hits", _hits, allocator);
+    out.AddMember("misses", _misses, allocator);
+    out.AddMember("evictions", _evictions, allocator);
+}
+
+void SnapshotCache::ResetCounters() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hits      = 0;
+    _misses    = 0;
+    _evictions = 0;
+}
+
+size_t SnapshotCache::EstimateBytes(const ReportSnapshot& snapshot) {
+    const std::vector<MarginCallEntry>& entries = snapshot.query_result.entries;
+
+    size_t bytes = sizeof(ReportSnapshot) + snapshot.group_index.MemoryUsage() +
+                   entries.capacity() * sizeof(MarginCallEntry);
+
+    for (const MarginCallEntry& entry : entries) {
+        bytes += StringBytes(entry.margin.group) + StringBytes(entry.name);
+    }
+
+    return bytes;
+}
+
+void SnapshotCache::EraseLocked(const std::unordered_map<std::string, Entry>::iterator it) {
+    _bytes -= it->second.bytes;
+    _entries.erase(it);
+    ++_evictions;
+}
+
+void SnapshotCache::EvictExpiredLocked(const Clock::time_point now) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (now - it->second.created >= _ttl) {
+            _bytes -= it->second.bytes;
+            it = _entries.erase(it);
+            ++_evictions;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SnapshotCache::EvictOldestLocked() {
+    auto oldest = _entries.begin();
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->second.created < oldest->second.created) {
+            oldest = it;
+        }
+    }
+    EraseLocked(oldest);
+}
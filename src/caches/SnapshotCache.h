@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "planners/QueryPlanner.h"
+#include "rapidjson/document.h"
+#include "structures/GroupIndex.h"
+
+// Данные отчета для одной маски групп: индекс групп и отфильтрованный набор margin call.
+// После вставки в кэш не меняется и читается запросами параллельно.
+struct ReportSnapshot {
+    GroupIndex      group_index;
+    QueryPlanResult query_result;
+};
+
+// Cross-request cache of ReportSnapshot keyed by the resolved group mask, so desks opening the
+// report for the same mask within the TTL skip the server fetches and the join.
+//
+// Configured from the environment of the report server on first use:
+// MARGINCALL_SNAPSHOT_TTL_MS (0 - cache disabled, the default) and MARGINCALL_SNAPSHOT_MAX_MB
+// (estimated memory of all snapshots, kDefaultMaxBytes if unset). Entries past the TTL are
+// never served; when an insert exceeds the memory limit the oldest entries are evicted first.
+// Requests keep the snapshot they got through shared_ptr, so eviction and Clear() (called from
+// DestroyReport) never free data in use.
+class SnapshotCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kDefaultMaxBytes = 256 * 1024 * 1024;
+
+    static SnapshotCache& Instance();
+
+    void Configure(std::chrono::milliseconds ttl, size_t max_bytes);
+
+    [[nodiscard]] bool Enabled() const;
+
+    // nullptr - промах (или кэш выключен)
+    [[nodiscard]] std::shared_ptr<const ReportSnapshot> Find(const std::string& group_mask);
+
+    void Insert(const std::string& group_mask, std::shared_ptr<const ReportSnapshot> snapshot);
+
+    // Drops all entries; counters and configuration are kept
+    void Clear();
+
+    // {"enabled", "ttl_ms", "max_bytes", "entries", "bytes", "hits", "misses", "evictions"}
+    void WriteTo(rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) const;
+
+    void ResetCounters();
+
+    // Оценка памяти снимка: векторы по capacity и строки вне SSO
+    static size_t EstimateBytes(const ReportSnapshot& snapshot);
+
+private:
+    struct Entry {
+        std::shared_ptr<const ReportSnapshot> snapshot;
+        Clock::time_point                     created;
+        size_t                                bytes = 0;
+    };
+
+    SnapshotCache();
+
+    void EraseLocked(std::unordered_map<std::string, Entry>::iterator it);
+
+    void EvictExpiredLocked(Clock::time_point now);
+
+    // Снимков немного (по одному на маску), поэтому самый старый ищется перебором
+    void EvictOldestLocked();
+
+    mutable std::mutex                     _mutex;
+    std::chrono::milliseconds              _ttl{0};
+    size_t                                 _max_bytes = kDefaultMaxBytes;
+    std::unordered_map<std::string, Entry> _entries;
+    size_t                                 _bytes     = 0;
+    uint64_t                               _hits      = 0;
+    uint64_t                               _misses    = 0;
+    uint64_t                               _evictions = 0;
+};
@@ -0,0 +1,133 @@
+#include "ValidationCache.h"
+
+#include "utils/Utils.h"
+
+using rapidjson::Value;
+
+ValidationCache& ValidationCache::Instance() {
+    static ValidationCache cache;
+    return cache;
+}
+
+ValidationCache::ValidationCache() {
+    _capacity = utils::EnvironmentValue("MARGINCALL_VALIDATION_CACHE_SIZE", kDefaultCapacity);
+    _ttl      = std::chrono::milliseconds(utils::EnvironmentValue(
+        "MARGINCALL_VALIDATION_CACHE_TTL_MS", static_cast<size_t>(kDefaultTtl.count())));
+}
+
+void ValidationCache::Configure(const size_t capacity, const std::chrono::milliseconds ttl) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = capacity;
+    _ttl      = ttl;
+
+    while (_lru.size() > _capacity) {
+        _entries.erase(_lru.back().key);
+        _lru.pop_back();
+    }
+}
+
+std::optional<ValidationResult> ValidationCache::Find(const ReportType   report_type,
+                                                      const std::string& access_groups,
+                                                      const std::string& requested_groups) {
+    const std::string key = Key(report_type, access_groups, requested_groups);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_capacity == 0) {
+        return std::nullopt;
+    }
+
+    const auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        ++_misses;
+        return std::nullopt;
+    }
+
+    // Устаревшая запись удаляется, проверка идет к серверу заново
+    if (_ttl.count() > 0 && Clock::now() - it->second->created >= _ttl) {
+        _lru.erase(it->second);
+        _entries.erase(it);
+        ++_expired;
+        ++_misses;
+        return std::nullopt;
+    }
+
+    // В начало списка - самая свежая запись
+    _lru.splice(_lru.begin(), _lru, it->second);
+    ++_hits;
+    return it->second->result;
+}
+
+void ValidationCache::Insert(const uint64_t          generation,
+                             const ReportType        report_type,
+                             const std::string&      access_groups,
+                             const std::string&      requested_groups,
+                             const ValidationResult& result) {
+    std::string key = Key(report_type, access_groups, requested_groups);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_capacity == 0 || generation != _generation) {
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+
+    if (const auto it = _entries.find(key); it != _entries.end()) {
+        it->second->result  = result;
+        it->second->created = now;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return;
+    }
+
+    if (_lru.size() >= _capacity) {
+        _entries.erase(_lru.back().key);
+        _lru.pop_back();
+    }
+
+    _lru.push_front({std::move(key), result, now});
+    _entries.emplace(_lru.front().key, _lru.begin());
+}
+
+uint64_t ValidationCache::Generation() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _generation;
+}
+
+void ValidationCache::Clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _lru.clear();
+    ++_generation;
+    ++_invalidations;
+}
+
+void ValidationCache::WriteTo(Value& out, rapidjson::Document::AllocatorType& allocator) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    out.SetObject();
+    out.AddMember("capacity", static_cast<uint64_t>(_capacity), allocator);
+    out.AddMember("ttl_ms", static_cast<int64_t>(_ttl.count()), allocator);
+    out.AddMember("entries", static_cast<uint64_t>(_lru.size()), allocator);
+    out.AddMember("hits", _hits, allocator);
+    out.AddMember("misses", _misses, allocator);
+    out.AddMember("expired", _expired, allocator);
+    out.AddMember("invalidations", _invalidations, allocator);
+}
+
+void ValidationCache::ResetCounters() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hits          = 0;
+    _misses        = 0;
+    _expired       = 0;
+    _invalidations = 0;
+}
+
+std::string ValidationCache::Key(const ReportType   report_type,
+                                 const std::string& access_groups,
+                                 const std::string& requested_groups) {
+    std::string key = std::to_string(static_cast<int>(report_type));
+    key.reserve(key.size() + access_groups.size() + requested_groups.size() + 2);
+    key.push_back('\0');
+    key.append(access_groups).push_back('\0');
+    key.append(requested_groups);
+    return key;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "rapidjson/document.h"
+#include "structures/ReportType.h"
+#include "structures/ValidationResult.h"
+
+// Bounded LRU of group access checks keyed by (report type, __access.groups, requested groups):
+// the same manager sessions repeat the same pair, and a repeated check is one hash lookup.
+//
+// The size comes from MARGINCALL_VALIDATION_CACHE_SIZE (kDefaultCapacity if unset, 0 disables
+// the cache). Group permissions can change on the server without an event reaching the plugin, so
+// an entry expires after MARGINCALL_VALIDATION_CACHE_TTL_MS (kDefaultTtl if unset, 0 - never).
+// Clear() is called on EV_TYPE_GROUP events (EventReport) and from DestroyReport.
+// Results computed before a Clear() are not inserted after it: callers pass the Generation()
+// they read before the check.
+class ValidationCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t                    kDefaultCapacity = 4096;
+    static constexpr std::chrono::milliseconds kDefaultTtl{60000};
+
+    static ValidationCache& Instance();
+
+    void Configure(size_t capacity, std::chrono::milliseconds ttl);
+
+    [[nodiscard]] std::optional<ValidationResult> Find(ReportType         report_type,
+                                                       const std::string& access_groups,
+                                                       const std::string& requested_groups);
+
+    void Insert(uint64_t                generation,
+                ReportType              report_type,
+                const std::string&      access_groups,
+                const std::string&      requested_groups,
+                const ValidationResult& result);
+
+    // Растет с каждым Clear()
+    [[nodiscard]] uint64_t Generation() const;
+
+    void Clear();
+
+    // {"capacity", "ttl_ms", "entries", "hits", "misses", "expired", "invalidations"}
+    void WriteTo(rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) const;
+
+    void ResetCounters();
+
+private:
+    struct Entry {
+        std::string       key;
+        ValidationResult  result;
+        Clock::time_point created;
+    };
+
+    ValidationCache();
+
+    static std::string Key(ReportType         report_type,
+                           const std::string& access_groups,
+                           const std::string& requested_groups);
+
+    mutable std::mutex                                          _mutex;
+    size_t                                                      _capacity = kDefaultCapacity;
+    std::chrono::milliseconds                                   _ttl      = kDefaultTtl;
+    std::list<Entry>                                            _lru; // от новых к старым
+    std::unordered_map<std::string, std::list<Entry>::iterator> _entries;
+    uint64_t                                                    _generation    = 0;
+    uint64_t                                                    _hits          = 0;
+    uint64_t                                                    _misses        = 0;
+    uint64_t                                                    _expired       = 0;
+    uint64_t                                                    _invalidations = 0;
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "ReportServerInterface.h"
+
+// Compact binary capture of ReportServerInterface responses.
+//
+// File:   "MCRC" | version (u32, little endian) | record*
+// Record: call id (u8) | key (string) | latency ns (varint) | return code (zigzag varint) |
+//         error (string, non-empty if the call threw) | payload
+//
+// Integers are LEB128 varints (signed ones zigzag encoded), doubles are raw 8 bytes,
+// strings and containers are prefixed with a varint length.
+//
+// Capture files lie on disk in plain form: account records keep only the login, group, name,
+// leverage and balance fields the report reads, group records go without SMTP credentials.
+// Passwords, OTP secrets, api_data and contact details of accounts are never written; replay
+// serves them empty.
+namespace capture {
+    inline constexpr char     kMagic[4] = {'M', 'C', 'R', 'C'};
+    inline constexpr uint32_t kVersion  = 2;
+
+    enum class CallId : uint8_t {
+        GetAccountsByGroup = 1,
+        GetAccountByLogin,
+        GetAccountBalanceByLogin,
+        GetMarginLevelByGroup,
+        GetAccountsEquitiesByGroup,
+        GetAccountsEquitiesByLogin,
+        GetOpenTradesByLogin,
+        GetPendingTradesByLogin,
+        GetCloseTradesByLogin,
+        GetOpenTradesByGroup,
+        GetCloseTradesByGroup,
+        GetPendingTradesByGroup,
+        GetAllOpenTrades,
+        GetTransactionsByGroup,
+        GetTransactionsByLogin,
+        CalculateConvertRateByCurrency,
+        MatchWildCardGroup,
+        GetGroup,
+        GetAllGroups
+    };
+
+    template <typename R, typename T>
+    concept RecordOf = std::is_same_v<std::remove_const_t<R>, T>;
+
+    // ---------- Record fields, shared by Writer and Reader ----------
+
+    template <typename Archive, RecordOf<ReportMarginLevel> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.login, r.group, r.leverage, r.balance, r.credit, r.bonus, r.equity, r.profit,
+           r.storage, r.commission, r.margin, r.margin_free, r.margin_level, r.margin_type,
+           r.level_type);
+    }
+
+    template <typename Archive, RecordOf<ReportEquityRecord> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.login, r.create_time, r.group, r.balance, r.prevbalance, r.credit, r.bonus, r.equity,
+           r.profit, r.storage, r.commission, r.margin, r.margin_free, r.margin_level, r.currency);
+    }
+
+    template <typename Archive, RecordOf<ReportAccountRecord> R>
+    void Fields(Archive& ar, R& r) {
+        // Без учетных данных и персональных данных (см. описание формата)
+        ar(r.login, r.group, r.enable, r.name, r.leverage, r.balance, r.prevmonthbalance,
+           r.prevbalance, r.credit, r.bonus, r.prevmonthequity, r.prevequity, r.margin);
+    }
+
+    template <typename Archive, RecordOf<ReportTradeRecord> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.order, r.login, r.symbol, r.digits, r.cmd, r.volume, r.parent_order, r.closed_volume,
+           r.partial_close_volume, r.open_time, r.state, r.open_price, r.sl, r.tp,
+           r.margin_initial, r.close_time, r.gw_volume, r.expiration, r.reason, r.conv_rates,
+           r.commission, r.prev_commission, r.commission_agent, r.storage, r.prev_storage,
+           r.profit, r.prev_profit, r.close_price, r.taxes, r.magic, r.comment, r.gw_order,
+           r.gw_source, r.gw_uuid, r.activation, r.gw_open_price, r.gw_close_price, r.margin_rate,
+           r.api_data, r.last_swap_time, r.update_time);
+    }
+
+    template <typename Archive, RecordOf<ReportGroupRecordSec> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.sec_index, r.show, r.trade, r.execution, r.comm_base, r.comm_type, r.comm_lots,
+           r.comm_agent, r.comm_agent_type, r.spread_diff, r.lot_min, r.lot_max, r.lot_step,
+           r.ie_deviation, r.confirmation, r.trade_rights, r.ie_quick_mode, r.autocloseout_mode,
+           r.comm_tax, r.comm_agent_lots, r.freemargin_mode, r.reserved);
+    }
+
+    template <typename Archive, RecordOf<ReportGroupRecordMargin> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.symbol, r.swap_enable, r.swap_long, r.swap_short, r.margin_divider, r.spread_enable,
+           r.spread, r.spread_balance, r.reserved);
+    }
+
+    template <typename Archive, RecordOf<ReportGroupRecord> R>
+    void Fields(Archive& ar, R& r) {
+        ar(r.grp_index, r.group, r.brand, r.account_mode, r.public_opening, r.enable, r.timeout,
+           r.otp_mode, r.signature, r.support_page, r.smtp_server, r.support_email, r.templates, r.copies, r.reports, r.default_leverage,
+           r.default_deposit, r.maxsecurities, r.secgroups, r.secmargins, r.secmargins_total,
+           r.currency, r.credit, r.credit_withdrawal_policy, r.withdrawal_margin_reserve,
+           r.bonus_usage_policy, r.margin_call, r.margin_mode, r.margin_stopout, r.interestrate,
+           r.use_swap, r.news, r.rights, r.check_ie_prices, r.maxpositions, r.close_reopen,
+           r.hedge_prohibited, r.allow_negative_margin_hedge, r.partial_close,
+           r.allow_sl_tp_slippage, r.close_fifo, r.hedge_largeleg, r.securities_hash,
+           r.margin_type, r.archive_period, r.archive_max_balance, r.stopout_skip_hedged,
+           r.archive_pending_period, r.news_languages, r.news_languages_total, r.reserved);
+    }
+
+    template <typename R, typename Archive>
+    concept HasFields = requires(Archive& ar, R& r) { Fields(ar, r); };
+
+    // ---------- Writer ----------
+
+    class Writer {
+    public:
+        std::string buffer;
+
+        template <typename... Values>
+        void operator()(const Values&... values) {
+            (Value(values), ...);
+        }
+
+        void Varint(uint64_t value) {
+            while (value >= 0x80) {
+                buffer.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<char>(value));
+        }
+
+        template <typename T>
+        void Value(const T& value) {
+            if constexpr (std::is_enum_v<T>) {
+                Value(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (std::is_same_v<T, bool>) {
+                buffer.push_back(value ? 1 : 0);
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                const auto wide = static_cast<int64_t>(value);
+                Varint((static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+            } else if constexpr (std::is_integral_v<T>) {
+                Varint(static_cast<uint64_t>(value));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                const double wide = value;
+                char         bytes[sizeof(double)];
+                std::memcpy(bytes, &wide, sizeof(double));
+                buffer.append(bytes, sizeof(double));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                Varint(value.size());
+                buffer.append(value);
+            } else if constexpr (HasFields<const T, Writer>) {
+                Fields(*this, value);
+            } else {
+                Container(value);
+            }
+        }
+
+        template <typename T, size_t N>
+        void Value(const T (&values)[N]) {
+            for (const auto& value : values) {
+                Value(value);
+            }
+        }
+
+    private:
+        template <typename T, size_t N>
+        void Container(const std::array<T, N>& values) {
+            for (const auto& value : values) {
+                Value(value);
+            }
+        }
+
+        template <typename T>
+        void Container(const std::vector<T>& values) {
+            Varint(values.size());
+            for (const auto& value : values) {
+                Value(value);
+            }
+        }
+
+        template <typename K, typename V>
+        void Container(const std::unordered_map<K, V>& values) {
+            Varint(values.size());
+            for (const auto& [key, value] : values) {
+                Value(key);
+                Value(value);
+            }
+        }
+    };
+
+    // ---------- Reader ----------
+
+    class Reader {
+    public:
+        Reader(const char* data, const size_t size) : _pos(data), _end(data + size) {}
+
+        [[nodiscard]] bool AtEnd() const { return _pos == _end; }
+
+        template <typename... Values>
+        void operator()(Values&... values) {
+            (Value(values), ...);
+        }
+
+        uint64_t Varint() {
+            uint64_t result = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const auto byte = static_cast<uint8_t>(Byte());
+                result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return result;
+                }
+            }
+            throw std::runtime_error("capture: malformed varint");
+        }
+
+        template <typename T>
+        void Value(T& value) {
+            if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> raw{};
+                Value(raw);
+                value = static_cast<T>(raw);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                value = Byte() != 0;
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                const uint64_t raw = Varint();
+                value = static_cast<T>(static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1));
+            } else if constexpr (std::is_integral_v<T>) {
+                value = static_cast<T>(Varint());
+            } else if constexpr (std::is_floating_point_v<T>) {
+                double wide = 0.0;
+                std::memcpy(&wide, Take(sizeof(double)), sizeof(double));
+                value = static_cast<T>(wide);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                const auto size = static_cast<size_t>(Varint());
+                value.assign(Take(size), size);
+            } else if constexpr (HasFields<T, Reader>) {
+                Fields(*this, value);
+            } else {
+                Container(value);
+            }
+        }
+
+        template <typename T, size_t N>
+        void Value(T (&values)[N]) {
+            for (auto& value : values) {
+                Value(value);
+            }
+        }
+
+    private:
+        const char* _pos;
+        const char* _end;
+
+        char Byte() { return *Take(1); }
+
+        const char* Take(const size_t size) {
+            if (static_cast<size_t>(_end - _pos) < size) {
+                throw std::runtime_error("capture: unexpected end of data");
+            }
+            const char* data = _pos;
+            _pos += size;
+            return data;
+        }
+
+        template <typename T, size_t N>
+        void Container(std::array<T, N>& values) {
+            for (auto& value : values) {
+                Value(value);
+            }
+        }
+
+        template <typename T>
+        void Container(std::vector<T>& values) {
+            const auto size = static_cast<size_t>(Varint());
+            values.clear();
+            values.resize(size);
+            for (auto& value : values) {
+                Value(value);
+            }
+        }
+
+        template <typename K, typename V>
+        void Container(std::unordered_map<K, V>& values) {
+            const auto size = static_cast<size_t>(Varint());
+            values.clear();
+            values.reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                K key{};
+                V value{};
+                Value(key);
+                Value(value);
+                values.emplace(std::move(key), std::move(value));
+            }
+        }
+    };
+} // namespace capture
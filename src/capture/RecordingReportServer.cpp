@@ -0,0 +1,235 @@
+#include "RecordingReportServer.h"
+
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    // Один файл может писаться из нескольких потоков и нескольких CreateReport сразу
+    std::mutex& CaptureFileMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+} // namespace
+
+RecordingReportServer::RecordingReportServer(ReportServerInterface* server,
+                                             const std::string&     path)
+    : _server(server) {
+    std::lock_guard lock(CaptureFileMutex());
+
+    std::error_code error;
+    const bool      is_new = !std::filesystem::exists(path, error) ||
+                        std::filesystem::file_size(path, error) == 0;
+
+    _file.open(path, std::ios::binary | std::ios::app);
+    if (!_file) {
+        throw std::runtime_error("capture: cannot open " + path);
+    }
+
+    if (is_new) {
+        char version[4];
+        for (int i = 0; i < 4; ++i) {
+            version[i] = static_cast<char>(capture::kVersion >> (8 * i));
+        }
+        _file.write(capture::kMagic, sizeof(capture::kMagic));
+        _file.write(version, sizeof(version));
+        _file.flush();
+    }
+}
+
+uint64_t RecordingReportServer::Elapsed(const std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count());
+}
+
+void RecordingReportServer::Write(const capture::CallId id,
+                                  const std::string&    key,
+                                  const uint64_t        latency_ns,
+                                  const int             code,
+                                  const std::string&    error,
+                                  const std::string&    payload) {
+    capture::Writer record;
+    record(id, key, latency_ns, code, error, payload);
+
+    // Запись целиком одним write, чтобы записи разных потоков не перемешивались
+    std::lock_guard lock(CaptureFileMutex());
+    _file.write(record.buffer.data(), static_cast<std::streamsize>(record.buffer.size()));
+    _file.flush();
+}
+
+int RecordingReportServer::GetLogs(time_t from, time_t to, const std::string& type,
+                                   const std::string& filter, std::vector<ReportServerLog>* logs) {
+    return _server->GetLogs(from, to, type, filter, logs);
+}
+
+int RecordingReportServer::GetAccountsByGroup(const std::string&                group,
+                                              std::vector<ReportAccountRecord>* accounts) {
+    return Record(capture::CallId::GetAccountsByGroup, Key(group), accounts,
+                  [&] { return _server->GetAccountsByGroup(group, accounts); });
+}
+
+int RecordingReportServer::GetAccountByLogin(int login, ReportAccountRecord* account) {
+    return Record(capture::CallId::GetAccountByLogin, Key(login), account,
+                  [&] { return _server->GetAccountByLogin(login, account); });
+}
+
+int RecordingReportServer::GetAccountBalanceByLogin(int login, ReportMarginLevel* margin) {
+    return Record(capture::CallId::GetAccountBalanceByLogin, Key(login), margin,
+                  [&] { return _server->GetAccountBalanceByLogin(login, margin); });
+}
+
+int RecordingReportServer::GetMarginLevelByGroup(const std::string&              group,
+                                                 std::vector<ReportMarginLevel>* margins) {
+    return Record(capture::CallId::GetMarginLevelByGroup, Key(group), margins,
+                  [&] { return _server->GetMarginLevelByGroup(group, margins); });
+}
+
+int RecordingReportServer::GetAccountsEquitiesByGroup(time_t from, time_t to,
+                                                      const std::string&               group_filter,
+                                                      std::vector<ReportEquityRecord>* equities) {
+    return Record(
+        capture::CallId::GetAccountsEquitiesByGroup, Key(from, to, group_filter), equities,
+        [&] { return _server->GetAccountsEquitiesByGroup(from, to, group_filter, equities); });
+}
+
+int RecordingReportServer::GetAccountsEquitiesByLogin(time_t from, time_t to, int login,
+                                                      std::vector<ReportEquityRecord>* equities) {
+    return Record(capture::CallId::GetAccountsEquitiesByLogin, Key(from, to, login), equities,
+                  [&] { return _server->GetAccountsEquitiesByLogin(from, to, login, equities); });
+}
+
+int RecordingReportServer::GetOpenTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetOpenTradesByLogin, Key(login), trades,
+                  [&] { return _server->GetOpenTradesByLogin(login, trades); });
+}
+
+int RecordingReportServer::GetPendingTradesByLogin(int                             login,
+                                                   std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetPendingTradesByLogin, Key(login), trades,
+                  [&] { return _server->GetPendingTradesByLogin(login, trades); });
+}
+
+int RecordingReportServer::GetOpenTradesByMagic(int magic, std::vector<ReportTradeRecord>* trades) {
+    return _server->GetOpenTradesByMagic(magic, trades);
+}
+
+int RecordingReportServer::GetOpenTradeByOrder(int order, ReportTradeRecord* trade) {
+    return _server->GetOpenTradeByOrder(order, trade);
+}
+
+int RecordingReportServer::GetOpenTradeByGwUUID(const std::string& gw_uuid,
+                                                ReportTradeRecord* trade) {
+    return _server->GetOpenTradeByGwUUID(gw_uuid, trade);
+}
+
+int RecordingReportServer::GetCloseTradeByGwUUID(const std::string& gw_uuid,
+                                                 ReportTradeRecord* trade) {
+    return _server->GetCloseTradeByGwUUID(gw_uuid, trade);
+}
+
+int RecordingReportServer::GetOpenTradeByGwOrder(const std::string& gw_order,
+                                                 ReportTradeRecord* trade) {
+    return _server->GetOpenTradeByGwOrder(gw_order, trade);
+}
+
+int RecordingReportServer::GetCloseTradeByGwOrder(const std::string& gw_order,
+                                                  ReportTradeRecord* trade) {
+    return _server->GetCloseTradeByGwOrder(gw_order, trade);
+}
+
+int RecordingReportServer::GetCloseTradesByLogin(int                             login,
+                                                 std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetCloseTradesByLogin, Key(login), trades,
+                  [&] { return _server->GetCloseTradesByLogin(login, trades); });
+}
+
+int RecordingReportServer::GetCloseTradesByGroup(const std::string& filter_group, time_t from,
+                                                 time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetCloseTradesByGroup, Key(filter_group, from, to), trades,
+                  [&] { return _server->GetCloseTradesByGroup(filter_group, from, to, trades); });
+}
+
+int RecordingReportServer::GetPendingTradesByGroup(const std::string& filter_group, time_t from,
+                                                   time_t                          to,
+                                                   std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetPendingTradesByGroup, Key(filter_group, from, to), trades,
+                  [&] { return _server->GetPendingTradesByGroup(filter_group, from, to, trades); });
+}
+
+int RecordingReportServer::GetOpenTradesByGroup(const std::string& filter_group, time_t from,
+                                                time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetOpenTradesByGroup, Key(filter_group, from, to), trades,
+                  [&] { return _server->GetOpenTradesByGroup(filter_group, from, to, trades); });
+}
+
+int RecordingReportServer::GetAllOpenTrades(std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetAllOpenTrades, Key(), trades,
+                  [&] { return _server->GetAllOpenTrades(trades); });
+}
+
+int RecordingReportServer::GetTransactionsByGroup(const std::string& filter_group, time_t from,
+                                                  time_t                          to,
+                                                  std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetTransactionsByGroup, Key(filter_group, from, to), trades,
+                  [&] { return _server->GetTransactionsByGroup(filter_group, from, to, trades); });
+}
+
+int RecordingReportServer::GetTransactionsByLogin(int login, time_t from, time_t to,
+                                                  std::vector<ReportTradeRecord>* trades) {
+    return Record(capture::CallId::GetTransactionsByLogin, Key(login, from, to), trades,
+                  [&] { return _server->GetTransactionsByLogin(login, from, to, trades); });
+}
+
+int RecordingReportServer::CalculateCommission(const ReportTradeRecord& trade,
+                                               double*                  calculated_commission) {
+    return _server->CalculateCommission(trade, calculated_commission);
+}
+
+int RecordingReportServer::CalculateSwap(const ReportTradeRecord& trade, double* calculated_swap) {
+    return _server->CalculateSwap(trade, calculated_swap);
+}
+
+int RecordingReportServer::CalculateProfit(const ReportTradeRecord& trade,
+                                           double*                  calculated_profit) {
+    return _server->CalculateProfit(trade, calculated_profit);
+}
+
+int RecordingReportServer::CalculateMargin(const ReportTradeRecord& trade,
+                                           double*                  calculated_margin) {
+    return _server->CalculateMargin(trade, calculated_margin);
+}
+
+int RecordingReportServer::CalculateConvertRateByCurrency(const std::string& from_cur,
+                                                          const std::string& to_cur, int cmd,
+                                                          double* multiplier) {
+    return Record(
+        capture::CallId::CalculateConvertRateByCurrency, Key(from_cur, to_cur, cmd), multiplier,
+        [&] { return _server->CalculateConvertRateByCurrency(from_cur, to_cur, cmd, multiplier); });
+}
+
+int RecordingReportServer::GetSymbol(const std::string& symbol, ReportSymbolRecord* cs) {
+    return _server->GetSymbol(symbol, cs);
+}
+
+int RecordingReportServer::MatchWildCardGroup(const std::string& mask, const std::string& group) {
+    return Record(capture::CallId::MatchWildCardGroup, Key(mask, group),
+                  static_cast<const int*>(nullptr),
+                  [&] { return _server->MatchWildCardGroup(mask, group); });
+}
+
+int RecordingReportServer::GetGroup(const std::string& group_name, ReportGroupRecord* group) {
+    return Record(capture::CallId::GetGroup, Key(group_name), group,
+                  [&] { return _server->GetGroup(group_name, group); });
+}
+
+int RecordingReportServer::GetAllGroups(std::vector<ReportGroupRecord>* groups) {
+    return Record(capture::CallId::GetAllGroups, Key(), groups,
+                  [&] { return _server->GetAllGroups(groups); });
+}
+
+int RecordingReportServer::GetCandles(const std::string& symbol, const std::string& frame,
+                                      time_t from, time_t to,
+                                      std::vector<ReportCandleRecord>* candles) {
+    return _server->GetCandles(symbol, frame, from, to, candles);
+}
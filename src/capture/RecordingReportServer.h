@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "CaptureFormat.h"
+#include "ReportServerInterface.h"
+
+// Decorator that forwards every call to the wrapped server and appends the results of the
+// data calls (accounts, margins, equities, trades, groups, rates) to a capture file.
+// Calls without a recorded counterpart pass through: logs, symbols, candles, the
+// commission/swap/profit/margin calculations and the single-trade lookups
+// (GetOpenTradesByMagic, GetOpenTradeByOrder, Get{Open,Close}TradeByGwUUID,
+// Get{Open,Close}TradeByGwOrder), which the report does not use.
+// Capture files are replayed by ReplayReportServer.
+class RecordingReportServer final : public ReportServerInterface {
+public:
+    RecordingReportServer(ReportServerInterface* server, const std::string& path);
+
+    int GetLogs(time_t from, time_t to, const std::string& type, const std::string& filter,
+                std::vector<ReportServerLog>* logs) override;
+
+    int GetAccountsByGroup(const std::string&                group,
+                           std::vector<ReportAccountRecord>* accounts) override;
+    int GetAccountByLogin(int login, ReportAccountRecord* account) override;
+    int GetAccountBalanceByLogin(int login, ReportMarginLevel* margin) override;
+    int GetMarginLevelByGroup(const std::string&              group,
+                              std::vector<ReportMarginLevel>* margins) override;
+    int GetAccountsEquitiesByGroup(time_t from, time_t to, const std::string& group_filter,
+                                   std::vector<ReportEquityRecord>* equities) override;
+    int GetAccountsEquitiesByLogin(time_t from, time_t to, int login,
+                                   std::vector<ReportEquityRecord>* equities) override;
+
+    int GetOpenTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetPendingTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradesByMagic(int magic, std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradeByOrder(int order, ReportTradeRecord* trade) override;
+    int GetOpenTradeByGwUUID(const std::string& gw_uuid, ReportTradeRecord* trade) override;
+    int GetCloseTradeByGwUUID(const std::string& gw_uuid, ReportTradeRecord* trade) override;
+    int GetOpenTradeByGwOrder(const std::string& gw_order, ReportTradeRecord* trade) override;
+    int GetCloseTradeByGwOrder(const std::string& gw_order, ReportTradeRecord* trade) override;
+    int GetCloseTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetCloseTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                              std::vector<ReportTradeRecord>* trades) override;
+    int GetPendingTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                                std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                             std::vector<ReportTradeRecord>* trades) override;
+    int GetAllOpenTrades(std::vector<ReportTradeRecord>* trades) override;
+    int GetTransactionsByGroup(const std::string& filter_group, time_t from, time_t to,
+                               std::vector<ReportTradeRecord>* trades) override;
+    int GetTransactionsByLogin(int login, time_t from, time_t to,
+                               std::vector<ReportTradeRecord>* trades) override;
+
+    int CalculateCommission(const ReportTradeRecord& trade, double* calculated_commission) override;
+    int CalculateSwap(const ReportTradeRecord& trade, double* calculated_swap) override;
+    int CalculateProfit(const ReportTradeRecord& trade, double* calculated_profit) override;
+    int CalculateMargin(const ReportTradeRecord& trade, double* calculated_margin) override;
+    int CalculateConvertRateByCurrency(const std::string& from_cur, const std::string& to_cur,
+                                       int cmd, double* multiplier) override;
+
+    int GetSymbol(const std::string& symbol, ReportSymbolRecord* cs) override;
+    int MatchWildCardGroup(const std::string& mask, const std::string& group) override;
+    int GetGroup(const std::string& group_name, ReportGroupRecord* group) override;
+    int GetAllGroups(std::vector<ReportGroupRecord>* groups) override;
+
+    int GetCandles(const std::string& symbol, const std::string& frame, time_t from, time_t to,
+                   std::vector<ReportCandleRecord>* candles) override;
+
+    // Ключ записи - закодированные аргументы вызова
+    template <typename... Args>
+    static std::string Key(const Args&... args) {
+        capture::Writer writer;
+        writer(args...);
+        return std::move(writer.buffer);
+    }
+
+private:
+    ReportServerInterface* _server;
+    std::ofstream          _file;
+
+    // Выполняет вызов, замеряет задержку и дописывает запись. Исключение записывается и
+    // пробрасывается дальше без изменений.
+    template <typename Result, typename Call>
+    int Record(const capture::CallId id, const std::string& key, const Result* result, Call call) {
+        const auto start = std::chrono::steady_clock::now();
+
+        int code = RET_ERROR;
+        try {
+            code = call();
+        } catch (const std::exception& e) {
+            Write(id, key, Elapsed(start), code, *e.what() ? e.what() : "unknown error", {});
+            throw;
+        }
+
+        capture::Writer payload;
+        if (result != nullptr) {
+            payload(*result);
+        }
+        Write(id, key, Elapsed(start), code, {}, payload.buffer);
+
+        return code;
+    }
+
+    static uint64_t Elapsed(std::chrono::steady_clock::time_point start);
+
+    void Write(capture::CallId    id,
+               const std::string& key,
+               uint64_t           latency_ns,
+               int                code,
+               const std::string& error,
+               const std::string& payload);
+};
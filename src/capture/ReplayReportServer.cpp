@@ -0,0 +1,217 @@
+#include "ReplayReportServer.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "RecordingReportServer.h"
+
+using capture::CallId;
+using Recorder = RecordingReportServer;
+
+ReplayReportServer::ReplayReportServer(const std::string& path, const ReplayLatency latency)
+    : _latency(latency) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("capture: cannot open " + path);
+    }
+
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < 8 || data.compare(0, 4, capture::kMagic, 4) != 0) {
+        throw std::runtime_error("capture: " + path + " is not a capture file");
+    }
+
+    uint32_t version = 0;
+    for (int i = 0; i < 4; ++i) {
+        version |= static_cast<uint32_t>(static_cast<uint8_t>(data[4 + i])) << (8 * i);
+    }
+    if (version != capture::kVersion) {
+        throw std::runtime_error("capture: unsupported version " + std::to_string(version));
+    }
+
+    capture::Reader reader(data.data() + 8, data.size() - 8);
+    while (!reader.AtEnd()) {
+        CallId       id{};
+        std::string  key;
+        CapturedCall call;
+        reader(id, key, call.latency_ns, call.code, call.error, call.payload);
+
+        _slots[SlotKey(id, key)].calls.push_back(std::move(call));
+        ++_records_count;
+    }
+}
+
+std::string ReplayReportServer::SlotKey(const CallId id, const std::string& key) {
+    std::string slot_key;
+    slot_key.reserve(key.size() + 1);
+    slot_key.push_back(static_cast<char>(id));
+    slot_key.append(key);
+    return slot_key;
+}
+
+const ReplayReportServer::CapturedCall* ReplayReportServer::Next(const CallId       id,
+                                                                 const std::string& key) {
+    std::lock_guard lock(_mutex);
+
+    const auto it = _slots.find(SlotKey(id, key));
+    if (it == _slots.end()) {
+        return nullptr;
+    }
+
+    CallSlot& slot = it->second;
+    const CapturedCall& call = slot.calls[slot.next];
+    slot.next = (slot.next + 1) % slot.calls.size();
+    return &call;
+}
+
+void ReplayReportServer::Wait(const CapturedCall& call) const {
+    if (_latency == ReplayLatency::Recorded && call.latency_ns > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(call.latency_ns));
+    }
+}
+
+int ReplayReportServer::GetLogs(time_t, time_t, const std::string&, const std::string&,
+                                std::vector<ReportServerLog>*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetAccountsByGroup(const std::string&                group,
+                                           std::vector<ReportAccountRecord>* accounts) {
+    return Serve(CallId::GetAccountsByGroup, Recorder::Key(group), accounts);
+}
+
+int ReplayReportServer::GetAccountByLogin(int login, ReportAccountRecord* account) {
+    return Serve(CallId::GetAccountByLogin, Recorder::Key(login), account);
+}
+
+int ReplayReportServer::GetAccountBalanceByLogin(int login, ReportMarginLevel* margin) {
+    return Serve(CallId::GetAccountBalanceByLogin, Recorder::Key(login), margin);
+}
+
+int ReplayReportServer::GetMarginLevelByGroup(const std::string&              group,
+                                              std::vector<ReportMarginLevel>* margins) {
+    return Serve(CallId::GetMarginLevelByGroup, Recorder::Key(group), margins);
+}
+
+int ReplayReportServer::GetAccountsEquitiesByGroup(time_t from, time_t to,
+                                                   const std::string&               group_filter,
+                                                   std::vector<ReportEquityRecord>* equities) {
+    return Serve(CallId::GetAccountsEquitiesByGroup, Recorder::Key(from, to, group_filter),
+                 equities);
+}
+
+int ReplayReportServer::GetAccountsEquitiesByLogin(time_t from, time_t to, int login,
+                                                   std::vector<ReportEquityRecord>* equities) {
+    return Serve(CallId::GetAccountsEquitiesByLogin, Recorder::Key(from, to, login), equities);
+}
+
+int ReplayReportServer::GetOpenTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetOpenTradesByLogin, Recorder::Key(login), trades);
+}
+
+int ReplayReportServer::GetPendingTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetPendingTradesByLogin, Recorder::Key(login), trades);
+}
+
+int ReplayReportServer::GetOpenTradesByMagic(int, std::vector<ReportTradeRecord>*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetOpenTradeByOrder(int, ReportTradeRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetOpenTradeByGwUUID(const std::string&, ReportTradeRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetCloseTradeByGwUUID(const std::string&, ReportTradeRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetOpenTradeByGwOrder(const std::string&, ReportTradeRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetCloseTradeByGwOrder(const std::string&, ReportTradeRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::GetCloseTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetCloseTradesByLogin, Recorder::Key(login), trades);
+}
+
+int ReplayReportServer::GetCloseTradesByGroup(const std::string& filter_group, time_t from,
+                                              time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetCloseTradesByGroup, Recorder::Key(filter_group, from, to), trades);
+}
+
+int ReplayReportServer::GetPendingTradesByGroup(const std::string& filter_group, time_t from,
+                                                time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetPendingTradesByGroup, Recorder::Key(filter_group, from, to), trades);
+}
+
+int ReplayReportServer::GetOpenTradesByGroup(const std::string& filter_group, time_t from,
+                                             time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetOpenTradesByGroup, Recorder::Key(filter_group, from, to), trades);
+}
+
+int ReplayReportServer::GetAllOpenTrades(std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetAllOpenTrades, Recorder::Key(), trades);
+}
+
+int ReplayReportServer::GetTransactionsByGroup(const std::string& filter_group, time_t from,
+                                               time_t to, std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetTransactionsByGroup, Recorder::Key(filter_group, from, to), trades);
+}
+
+int ReplayReportServer::GetTransactionsByLogin(int login, time_t from, time_t to,
+                                               std::vector<ReportTradeRecord>* trades) {
+    return Serve(CallId::GetTransactionsByLogin, Recorder::Key(login, from, to), trades);
+}
+
+int ReplayReportServer::CalculateCommission(const ReportTradeRecord&, double*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::CalculateSwap(const ReportTradeRecord&, double*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::CalculateProfit(const ReportTradeRecord&, double*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::CalculateMargin(const ReportTradeRecord&, double*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::CalculateConvertRateByCurrency(const std::string& from_cur,
+                                                       const std::string& to_cur, int cmd,
+                                                       double* multiplier) {
+    return Serve(CallId::CalculateConvertRateByCurrency, Recorder::Key(from_cur, to_cur, cmd),
+                 multiplier);
+}
+
+int ReplayReportServer::GetSymbol(const std::string&, ReportSymbolRecord*) {
+    return RET_ERR_NOTFOUND;
+}
+
+int ReplayReportServer::MatchWildCardGroup(const std::string& mask, const std::string& group) {
+    return Serve(CallId::MatchWildCardGroup, Recorder::Key(mask, group), static_cast<int*>(nullptr));
+}
+
+int ReplayReportServer::GetGroup(const std::string& group_name, ReportGroupRecord* group) {
+    return Serve(CallId::GetGroup, Recorder::Key(group_name), group);
+}
+
+int ReplayReportServer::GetAllGroups(std::vector<ReportGroupRecord>* groups) {
+    return Serve(CallId::GetAllGroups, Recorder::Key(), groups);
+}
+
+int ReplayReportServer::GetCandles(const std::string&, const std::string&, time_t, time_t,
+                                   std::vector<ReportCandleRecord>*) {
+    return RET_ERR_NOTFOUND;
+}
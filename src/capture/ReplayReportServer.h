@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CaptureFormat.h"
+#include "ReportServerInterface.h"
+
+enum class ReplayLatency {
+    FullSpeed, // ответы отдаются сразу
+    Recorded   // перед ответом выдерживается записанная задержка
+};
+
+// Serves a capture file written by RecordingReportServer. Records are matched by call and
+// arguments; repeated calls get the recorded responses in order, wrapping around at the end.
+// Calls that were not recorded return RET_ERR_NOTFOUND and leave the output untouched.
+class ReplayReportServer final : public ReportServerInterface {
+public:
+    explicit ReplayReportServer(const std::string& path,
+                                ReplayLatency      latency = ReplayLatency::FullSpeed);
+
+    [[nodiscard]] size_t RecordsCount() const { return _records_count; }
+
+    std::atomic<size_t> calls_count{0};
+
+    int GetLogs(time_t from, time_t to, const std::string& type, const std::string& filter,
+                std::vector<ReportServerLog>* logs) override;
+
+    int GetAccountsByGroup(const std::string&                group,
+                           std::vector<ReportAccountRecord>* accounts) override;
+    int GetAccountByLogin(int login, ReportAccountRecord* account) override;
+    int GetAccountBalanceByLogin(int login, ReportMarginLevel* margin) override;
+    int GetMarginLevelByGroup(const std::string&              group,
+                              std::vector<ReportMarginLevel>* margins) override;
+    int GetAccountsEquitiesByGroup(time_t from, time_t to, const std::string& group_filter,
+                                   std::vector<ReportEquityRecord>* equities) override;
+    int GetAccountsEquitiesByLogin(time_t from, time_t to, int login,
+                                   std::vector<ReportEquityRecord>* equities) override;
+
+    int GetOpenTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetPendingTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradesByMagic(int magic, std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradeByOrder(int order, ReportTradeRecord* trade) override;
+    int GetOpenTradeByGwUUID(const std::string& gw_uuid, ReportTradeRecord* trade) override;
+    int GetCloseTradeByGwUUID(const std::string& gw_uuid, ReportTradeRecord* trade) override;
+    int GetOpenTradeByGwOrder(const std::string& gw_order, ReportTradeRecord* trade) override;
+    int GetCloseTradeByGwOrder(const std::string& gw_order, ReportTradeRecord* trade) override;
+    int GetCloseTradesByLogin(int login, std::vector<ReportTradeRecord>* trades) override;
+    int GetCloseTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                              std::vector<ReportTradeRecord>* trades) override;
+    int GetPendingTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                                std::vector<ReportTradeRecord>* trades) override;
+    int GetOpenTradesByGroup(const std::string& filter_group, time_t from, time_t to,
+                             std::vector<ReportTradeRecord>* trades) override;
+    int GetAllOpenTrades(std::vector<ReportTradeRecord>* trades) override;
+    int GetTransactionsByGroup(const std::string& filter_group, time_t from, time_t to,
+                               std::vector<ReportTradeRecord>* trades) override;
+    int GetTransactionsByLogin(int login, time_t from, time_t to,
+                               std::vector<ReportTradeRecord>* trades) override;
+
+    int CalculateCommission(const ReportTradeRecord& trade, double* calculated_commission) override;
+    int CalculateSwap(const ReportTradeRecord& trade, double* calculated_swap) override;
+    int CalculateProfit(const ReportTradeRecord& trade, double* calculated_profit) override;
+    int CalculateMargin(const ReportTradeRecord& trade, double* calculated_margin) override;
+    int CalculateConvertRateByCurrency(const std::string& from_cur, const std::string& to_cur,
+                                       int cmd, double* multiplier) override;
+
+    int GetSymbol(const std::string& symbol, ReportSymbolRecord* cs) override;
+    int MatchWildCardGroup(const std::string& mask, const std::string& group) override;
+    int GetGroup(const std::string& group_name, ReportGroupRecord* group) override;
+    int GetAllGroups(std::vector<ReportGroupRecord>* groups) override;
+
+    int GetCandles(const std::string& symbol, const std::string& frame, time_t from, time_t to,
+                   std::vector<ReportCandleRecord>* candles) override;
+
+private:
+    struct CapturedCall {
+        uint64_t    latency_ns = 0;
+        int         code       = RET_OK;
+        std::string error;
+        std::string payload;
+    };
+
+    struct CallSlot {
+        std::vector<CapturedCall> calls;
+        size_t                    next = 0;
+    };
+
+    ReplayLatency                             _latency;
+    size_t                                    _records_count = 0;
+    std::mutex                                _mutex;
+    std::unordered_map<std::string, CallSlot> _slots; // call id + ключ аргументов
+
+    static std::string SlotKey(capture::CallId id, const std::string& key);
+
+    // Выбирает очередную запись под мьютексом, остальное - без блокировки
+    template <typename Result>
+    int Serve(const capture::CallId id, const std::string& key, Result* result) {
+        calls_count.fetch_add(1, std::memory_order_relaxed);
+
+        const CapturedCall* call = Next(id, key);
+        if (call == nullptr) {
+            return RET_ERR_NOTFOUND;
+        }
+
+        Wait(*call);
+
+        if (!call->error.empty()) {
+            throw std::runtime_error(call->error);
+        }
+
+        if (result != nullptr && !call->payload.empty()) {
+            capture::Reader reader(call->payload.data(), call->payload.size());
+            reader(*result);
+        }
+
+        return call->code;
+    }
+
+    const CapturedCall* Next(capture::CallId id, const std::string& key);
+    void                Wait(const CapturedCall& call) const;
+};
@@ -0,0 +1,163 @@
+#include "CborWriter.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace encoding {
+    void CborWriter::WriteHead(const uint8_t major, const uint64_t argument) {
+        const auto type = static_cast<uint8_t>(major << 5);
+
+        if (argument < 24) {
+            Put(type | static_cast<uint8_t>(argument));
+            return;
+        }
+
+        int bytes;
+        if (argument <= 0xff) {
+            Put(type | 24);
+            bytes = 1;
+        } else if (argument <= 0xffff) {
+            Put(type | 25);
+            bytes = 2;
+        } else if (argument <= 0xffffffff) {
+            Put(type | 26);
+            bytes = 4;
+        } else {
+            Put(type | 27);
+            bytes = 8;
+        }
+
+        // Big endian
+        for (int i = bytes - 1; i >= 0; --i) {
+            Put(static_cast<uint8_t>(argument >> (i * 8)));
+        }
+    }
+
+    bool CborWriter::Int64(const int64_t value) {
+        if (value >= 0) {
+            WriteHead(0, static_cast<uint64_t>(value));
+        } else {
+            // Отрицательное n кодируется как -1 - n
+            WriteHead(1, static_cast<uint64_t>(-(value + 1)));
+        }
+        return true;
+    }
+
+    bool CborWriter::Uint64(const uint64_t value) {
+        WriteHead(0, value);
+        return true;
+    }
+
+    bool CborWriter::Double(const double value) {
+        const auto as_float = static_cast<float>(value);
+
+        if (static_cast<double>(as_float) == value || value != value) {
+            uint32_t bits;
+            std::memcpy(&bits, &as_float, sizeof(bits));
+            Put(0xfa);
+            for (int i = 3; i >= 0; --i) {
+                Put(static_cast<uint8_t>(bits >> (i * 8)));
+            }
+            return true;
+        }
+
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Put(0xfb);
+        for (int i = 7; i >= 0; --i) {
+            Put(static_cast<uint8_t>(bits >> (i * 8)));
+        }
+        return true;
+    }
+
+    bool CborWriter::RawNumber(const Ch* str, const rapidjson::SizeType length, bool) {
+        // "[-]digits[.digits]" (Decimal::Write): целое или decimal fraction (tag 4) -
+        // [показатель, мантисса] без округления в double
+        const Ch* position = str;
+        const Ch* end      = str + length;
+        const bool negative = position != end && *position == '-';
+        if (negative) {
+            ++position;
+        }
+
+        uint64_t mantissa        = 0;
+        int      fraction_digits = 0;
+        bool     fraction        = false;
+        bool     valid           = position != end;
+        for (; position != end && valid; ++position) {
+            if (*position == '.' && !fraction) {
+                fraction = true;
+                continue;
+            }
+            // 18 цифр всегда помещаются в int64
+            valid = *position >= '0' && *position <= '9' && mantissa < 100000000000000000ull;
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*position - '0');
+            fraction_digits += fraction ? 1 : 0;
+        }
+
+        if (valid) {
+            const auto value = negative ? -static_cast<int64_t>(mantissa)
+                                        : static_cast<int64_t>(mantissa);
+            if (fraction_digits == 0) {
+                return Int64(value);
+            }
+            WriteHead(6, 4);
+            WriteHead(4, 2);
+            Int64(-fraction_digits);
+            return Int64(value);
+        }
+
+        // Прочие записи чисел (экспонента) - через double
+        char buffer[64];
+        if (length >= sizeof(buffer)) {
+            return false;
+        }
+        std::memcpy(buffer, str, length);
+        buffer[length] = '\0';
+        return Double(std::strtod(buffer, nullptr));
+    }
+
+    bool CborWriter::String(const Ch* str, const rapidjson::SizeType length, bool) {
+        WriteHead(3, length);
+        _out.append(str, length);
+        return true;
+    }
+
+    bool CborWriter::String(const Ch* str) {
+        return String(str, static_cast<rapidjson::SizeType>(std::strlen(str)), true);
+    }
+
+    size_t Base64Size(const size_t size) {
+        return (size + 2) / 3 * 4;
+    }
+
+    void Base64Encode(const uint8_t* data, const size_t size, char* out) {
+        static constexpr char kAlphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        size_t i = 0;
+        for (; i + 3 <= size; i += 3) {
+            const uint32_t triple = (static_cast<uint32_t>(data[i]) << 16) |
+                                    (static_cast<uint32_t>(data[i + 1]) << 8) | data[i + 2];
+            *out++ = kAlphabet[(triple >> 18) & 0x3f];
+            *out++ = kAlphabet[(triple >> 12) & 0x3f];
+            *out++ = kAlphabet[(triple >> 6) & 0x3f];
+            *out++ = kAlphabet[triple & 0x3f];
+        }
+
+        const size_t rest = size - i;
+        if (rest == 0) {
+            return;
+        }
+
+        uint32_t triple = static_cast<uint32_t>(data[i]) << 16;
+        if (rest == 2) {
+            triple |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+
+        *out++ = kAlphabet[(triple >> 18) & 0x3f];
+        *out++ = kAlphabet[(triple >> 12) & 0x3f];
+        *out++ = rest == 2 ? kAlphabet[(triple >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+} // namespace encoding
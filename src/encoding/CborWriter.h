@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "rapidjson/rapidjson.h"
+
+// CBOR (RFC 8949) encoder with the rapidjson Handler interface: anything that already writes
+// SAX events (ast::write_json, TableBuilder::StreamTableProps, utils::WriteUI) can stream into
+// it instead of a JSON Writer.
+//
+// Arrays and objects are written as indefinite-length items (0x9f / 0xbf ... 0xff), because SAX
+// gives the element count only at the end. Integers take the shortest form, doubles that are
+// exact in float32 take 5 bytes instead of 9. Raw numbers (the Decimal money cells of
+// TableBuilder) become integers or decimal fractions (tag 4, [exponent, mantissa]): 6-8 bytes
+// for typical amounts, and exact.
+namespace encoding {
+    class CborWriter {
+    public:
+        using Ch = char;
+
+        explicit CborWriter(std::string& out) : _out(out) {}
+
+        bool Null() { return Put(0xf6); }
+        bool Bool(const bool value) { return Put(value ? 0xf5 : 0xf4); }
+        bool Int(const int value) { return Int64(value); }
+        bool Uint(const unsigned value) { return Uint64(value); }
+        bool Int64(int64_t value);
+        bool Uint64(uint64_t value);
+        bool Double(double value);
+
+        // Текст числа (Decimal-ячейки TableBuilder): целое или tag 4, иначе double
+        bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy = true);
+
+        bool String(const Ch* str, rapidjson::SizeType length, bool = true);
+
+        bool StartObject() { return Put(0xbf); }
+        bool Key(const Ch* str, const rapidjson::SizeType length, const bool copy = true) {
+            return String(str, length, copy);
+        }
+        bool EndObject(rapidjson::SizeType = 0) { return Put(0xff); }
+
+        bool StartArray() { return Put(0x9f); }
+        bool EndArray(rapidjson::SizeType = 0) { return Put(0xff); }
+
+        // Перегрузки rapidjson Writer для литералов
+        bool String(const Ch* str);
+        bool Key(const Ch* str) { return String(str); }
+
+    private:
+        std::string& _out;
+
+        bool Put(const int byte) {
+            _out.push_back(static_cast<char>(byte));
+            return true;
+        }
+
+        // Заголовок элемента: major type и аргумент в кратчайшей форме
+        void WriteHead(uint8_t major, uint64_t argument);
+    };
+
+    // Base64 (RFC 4648) без переносов строк; out - не меньше Base64Size(size) байт
+    size_t Base64Size(size_t size);
+    void   Base64Encode(const uint8_t* data, size_t size, char* out);
+} // namespace encoding
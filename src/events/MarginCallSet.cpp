@@ -0,0 +1,623 @@
+#include "MarginCallSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "planners/QueryPlanner.h"
+#include "utils/Utils.h"
+
+namespace {
+    // Строка в отчете не изменится - событие не дает новой версии
+    bool SameRow(const MarginCallEntry& lhs, const MarginCallEntry& rhs) {
+        const ReportMarginLevel& a = lhs.margin;
+        const ReportMarginLevel& b = rhs.margin;
+        return lhs.name == rhs.name && a.group == b.group && a.leverage == b.leverage &&
+               a.balance == b.balance && a.credit == b.credit && a.equity == b.equity &&
+               a.margin == b.margin && a.margin_free == b.margin_free &&
+               a.margin_level == b.margin_level && a.level_type == b.level_type;
+    }
+} // namespace
+
+MarginCallSet& MarginCallSet::Instance() {
+    static MarginCallSet margin_call_set;
+    return margin_call_set;
+}
+
+MarginCallSet::MarginCallSet() {
+    std::random_device random;
+    _epoch = (static_cast<uint64_t>(random()) << 32) ^ random() ^
+             static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+    _reseed_interval = std::chrono::milliseconds(utils::EnvironmentValue(
+        "MARGINCALL_SET_RESEED_MS", static_cast<size_t>(kDefaultReseedInterval.count())));
+}
+
+void MarginCallSet::Configure(const std::chrono::milliseconds reseed_interval) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _reseed_interval = reseed_interval;
+}
+
+bool MarginCallSet::Active() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _active;
+}
+
+EventsResult MarginCallSet::Apply(const std::vector<ReportEvent>& events,
+                                  ReportServerInterface*          server) {
+    EventsResult             result;
+    std::vector<ReportEvent> logins;
+    bool                     invalidate = false;
+
+    for (const ReportEvent& event : events) {
+        switch (event.type) {
+            case EV_TYPE_BALANCE:
+            case EV_TYPE_TRADE:
+            case EV_TYPE_ACCOUNT:
+                if (event.login <= 0) {
+                    ++result.ignored;
+                    continue;
+                }
+                logins.push_back(event);
+                break;
+            case EV_TYPE_GROUP: invalidate = true; break;
+            default: ++result.ignored; continue;
+        }
+        ++result.applied;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _active = true;
+
+        if (invalidate) {
+            InvalidateLocked();
+        }
+
+        // Логины событий, пришедших во время Seed, он перечитает после себя. Маски, которые
+        // заполняются впервые, строк еще не ведут
+        bool seeded = false;
+        for (const auto& [mask, view] : _views) {
+            if (view->seeding) {
+                for (const ReportEvent& event : logins) {
+                    view->pending.insert(event.login);
+                }
+            }
+            seeded = seeded || view->seeded;
+        }
+        if (!seeded) {
+            return result;
+        }
+    }
+
+    RefreshLogins(logins, server);
+    return result;
+}
+
+bool MarginCallSet::Select(const std::string&            group_mask,
+                           ReportServerInterface*        server,
+                           MarginCallSelection&          selection,
+                           const std::optional<uint64_t> since) {
+    std::shared_ptr<View> view;
+    bool                  seed = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_active) {
+            return false;
+        }
+
+        view       = ViewLocked(group_mask);
+        view->used = ++_uses;
+
+        // Заполнение идет в этом запросе; при повторном остальные пока читают текущие строки
+        if (!view->seeding && (!view->seeded || ReseedDueLocked(*view))) {
+            view->seeding = true;
+            seed          = true;
+        }
+    }
+
+    if (seed) {
+        Seed(view, server);
+    }
+
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!view->seeded || !CurrentLocked(view)) {
+            return false;
+        }
+
+        selection.entries = view->entries;
+        selection.version = _version;
+
+        // Журнал покрывает (since, _version], если since не старше его начала
+        selection.delta = since && *since >= view->changes_base && *since <= _version;
+        if (selection.delta) {
+            for (auto it = view->changes.rbegin();
+                 it != view->changes.rend() && it->version > *since;
+                 ++it) {
+                changes.push_back(*it);
+            }
+        }
+    }
+
+    selection.changed.clear();
+    selection.removed.clear();
+    if (!selection.delta) {
+        return true;
+    }
+
+    const std::vector<MarginCallEntry>& entries = selection.entries;
+
+    LoginIndex mask_logins(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        mask_logins.Insert(entries[i].margin.login, static_cast<uint32_t>(i));
+    }
+
+    // Строка, которая сейчас в маске, - изменена; которой нет - удалена. Журнал читается от
+    // новых записей к старым
+    std::unordered_set<int> seen;
+    for (const Change& change : changes) {
+        if (!seen.insert(change.login).second) {
+            continue;
+        }
+        if (const uint32_t position = mask_logins.Find(change.login);
+            position != LoginIndex::kNotFound) {
+            selection.changed.push_back(position);
+        } else {
+            selection.removed.push_back(change.login);
+        }
+    }
+
+    return true;
+}
+
+void MarginCallSet::Invalidate() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    InvalidateLocked();
+}
+
+void MarginCallSet::Reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _active = false;
+    InvalidateLocked();
+}
+
+std::string MarginCallSet::VersionToken(const uint64_t version) const {
+    return std::to_string(_epoch) + "-" + std::to_string(version);
+}
+
+std::optional<uint64_t> MarginCallSet::ParseVersionToken(const std::string& token) const {
+    const size_t separator = token.find('-');
+    if (separator == std::string::npos || separator + 1 >= token.size()) {
+        return std::nullopt;
+    }
+
+    char* end = nullptr;
+    if (std::strtoull(token.c_str(), &end, 10) != _epoch || end != token.c_str() + separator) {
+        return std::nullopt;
+    }
+
+    const char*    version_begin = token.c_str() + separator + 1;
+    const uint64_t version       = std::strtoull(version_begin, &end, 10);
+    if (*end != '\0') {
+        return std::nullopt;
+    }
+    return version;
+}
+
+uint64_t MarginCallSet::Version() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _version;
+}
+
+size_t MarginCallSet::Size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    size_t size = 0;
+    for (const auto& [mask, view] : _views) {
+        size += view->entries.size();
+    }
+    return size;
+}
+
+size_t MarginCallSet::Views() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _views.size();
+}
+
+bool MarginCallSet::Seeded() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::any_of(_views.begin(), _views.end(), [](const auto& item) {
+        return item.second->seeded;
+    });
+}
+
+MarginCallSet::Refresh MarginCallSet::Read(const ReportEvent&     event,
+                                           ReportServerInterface* server) {
+    Refresh refresh;
+    refresh.login = event.login;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        refresh.ticket = ++_tickets;
+
+        // Имя и группа меняются только событиями аккаунта: для строки, которая уже есть в
+        // наборе, они не перечитываются
+        if (event.type != EV_TYPE_ACCOUNT) {
+            refresh.keep_name = std::any_of(_views.begin(), _views.end(), [&](const auto& item) {
+                return item.second->logins.Contains(event.login);
+            });
+        }
+    }
+
+    if (event.type == EV_TYPE_ACCOUNT && event.record == EV_RECORD_DELETE) {
+        return refresh;
+    }
+
+    ReportMarginLevel margin_level;
+    try {
+        if (server->GetAccountBalanceByLogin(event.login, &margin_level) != RET_OK ||
+            margin_level.login != event.login || !QueryPlanner::IsMarginCall(margin_level)) {
+            return refresh;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[MarginCallReportInterface]: GetAccountBalanceByLogin(" << event.login
+                  << "): " << e.what() << std::endl;
+        return refresh;
+    }
+
+    refresh.in_set = true;
+
+    if (!refresh.keep_name) {
+        ReportAccountRecord account;
+        try {
+            server->GetAccountByLogin(event.login, &account);
+        } catch (const std::exception& e) {
+            std::cerr << "[MarginCallReportInterface]: GetAccountByLogin(" << event.login
+                      << "): " << e.what() << std::endl;
+        }
+
+        // Аккаунт не найден - как и при запросе по логинам, строку не показываем
+        if (account.login != event.login) {
+            refresh.in_set = false;
+            return refresh;
+        }
+
+        if (margin_level.group.empty()) {
+            margin_level.group = std::move(account.group);
+        }
+        refresh.entry.name = std::move(account.name);
+    }
+
+    refresh.entry.margin = std::move(margin_level);
+    return refresh;
+}
+
+void MarginCallSet::RefreshLogins(const std::vector<ReportEvent>& events,
+                                  ReportServerInterface*          server) {
+    std::vector<ReportEvent> retry;
+
+    const auto refresh_login = [&](const ReportEvent& event) {
+        Refresh refresh = Read(event, server);
+
+        std::vector<std::pair<std::shared_ptr<View>, std::string>> checks;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            if (refresh.keep_name) {
+                const MarginCallEntry* current = nullptr;
+                for (const auto& [mask, view] : _views) {
+                    if (const uint32_t position = view->logins.Find(refresh.login);
+                        position != LoginIndex::kNotFound) {
+                        current = &view->entries[position];
+                        break;
+                    }
+                }
+
+                // Строку удалили между чтением и применением - имя придется перечитать
+                if (current == nullptr) {
+                    return false;
+                }
+                if (refresh.entry.margin.group.empty()) {
+                    refresh.entry.margin.group = current->margin.group;
+                }
+                refresh.entry.name = current->name;
+                refresh.keep_name  = false;
+            }
+
+            if (refresh.in_set) {
+                for (const auto& [mask, view] : _views) {
+                    if (view->seeded && !view->groups.contains(refresh.entry.margin.group)) {
+                        checks.emplace_back(view, refresh.entry.margin.group);
+                    }
+                }
+            }
+        }
+
+        if (!checks.empty()) {
+            MatchGroups(checks, server);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Более позднее чтение этого логина уже применено
+        uint64_t& applied = _applied[refresh.login];
+        if (refresh.ticket <= applied) {
+            return true;
+        }
+        applied = refresh.ticket;
+
+        for (const auto& [mask, view] : _views) {
+            if (view->seeded) {
+                ApplyLocked(*view, refresh);
+            }
+        }
+        return true;
+    };
+
+    for (const ReportEvent& event : events) {
+        if (!refresh_login(event)) {
+            retry.push_back({EV_TYPE_ACCOUNT, EV_RECORD_UPDATE, event.login});
+        }
+    }
+
+    for (const ReportEvent& event : retry) {
+        refresh_login(event);
+    }
+}
+
+void MarginCallSet::MatchGroups(
+    const std::vector<std::pair<std::shared_ptr<View>, std::string>>& checks,
+    ReportServerInterface*                                          server) {
+    std::vector<std::pair<size_t, bool>> answers;
+    answers.reserve(checks.size());
+
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const auto& [view, group] = checks[i];
+        try {
+            answers.emplace_back(i, server->MatchWildCardGroup(view->mask, group) == RET_OK);
+        } catch (const std::exception& e) {
+            // Ошибка не запоминается: строка не войдет в маску до следующего события
+            std::cerr << "[MarginCallReportInterface]: MatchWildCardGroup(" << view->mask << ", "
+                      << group << "): " << e.what() << std::endl;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& [index, matches] : answers) {
+        const auto& [view, group] = checks[index];
+        if (CurrentLocked(view)) {
+            view->groups.emplace(group, matches);
+        }
+    }
+}
+
+void MarginCallSet::ApplyLocked(View& view, const Refresh& refresh) {
+    // Строки заполнения новее этого чтения
+    if (refresh.ticket <= view.seed_ticket) {
+        return;
+    }
+
+    bool member = false;
+    if (refresh.in_set) {
+        const auto it = view.groups.find(refresh.entry.margin.group);
+        member        = it != view.groups.end() && it->second;
+    }
+
+    const uint32_t position = view.logins.Find(refresh.login);
+
+    if (!member) {
+        if (position != LoginIndex::kNotFound) {
+            ++_version;
+            LogChangeLocked(view, refresh.login);
+            EraseLocked(view, refresh.login);
+        }
+        return;
+    }
+
+    if (position == LoginIndex::kNotFound) {
+        ++_version;
+        LogChangeLocked(view, refresh.login);
+        view.logins.Insert(refresh.login, static_cast<uint32_t>(view.entries.size()));
+        view.entries.push_back(refresh.entry);
+        return;
+    }
+
+    MarginCallEntry& entry = view.entries[position];
+    if (SameRow(entry, refresh.entry)) {
+        return;
+    }
+
+    ++_version;
+    LogChangeLocked(view, refresh.login);
+    entry = refresh.entry;
+}
+
+void MarginCallSet::InvalidateLocked() {
+    _views.clear();
+    _applied.clear();
+    ++_version;
+    ++_resets;
+}
+
+bool MarginCallSet::CurrentLocked(const std::shared_ptr<View>& view) const {
+    const auto it = _views.find(view->mask);
+    return it != _views.end() && it->second == view;
+}
+
+std::shared_ptr<MarginCallSet::View> MarginCallSet::ViewLocked(const std::string& group_mask) {
+    if (const auto it = _views.find(group_mask); it != _views.end()) {
+        return it->second;
+    }
+
+    if (_views.size() >= kMaxViews) {
+        const auto oldest = std::min_element(
+            _views.begin(), _views.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second->used < rhs.second->used;
+            });
+        _views.erase(oldest);
+    }
+
+    auto view  = std::make_shared<View>();
+    view->mask = group_mask;
+    _views.emplace(group_mask, view);
+    return view;
+}
+
+void MarginCallSet::LogChangeLocked(View& view, const int login) {
+    view.changes.push_back({_version, login});
+
+    if (view.changes.size() > kMaxChanges) {
+        // Версии до вытесненной записи больше не восстановить
+        view.changes_base = view.changes.front().version;
+        view.changes.pop_front();
+    }
+}
+
+void MarginCallSet::RestartChangesLocked(View& view) {
+    view.changes.clear();
+    view.changes_base = _version;
+}
+
+void MarginCallSet::EraseLocked(View& view, const int login) {
+    const uint32_t position = view.logins.Find(login);
+    view.logins.Erase(login);
+
+    // Последняя строка занимает место удаленной
+    const auto last = static_cast<uint32_t>(view.entries.size() - 1);
+    if (position != last) {
+        const int moved_login   = view.entries[last].margin.login;
+        view.entries[position] = std::move(view.entries[last]);
+        view.logins.Erase(moved_login);
+        view.logins.Insert(moved_login, position);
+    }
+    view.entries.pop_back();
+}
+
+void MarginCallSet::Seed(const std::shared_ptr<View>& view, ReportServerInterface* server) {
+    uint64_t start_resets = 0;
+    uint64_t ticket       = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        start_resets = _resets;
+        ticket       = ++_tickets;
+        view->pending.clear();
+    }
+
+    // Та же выборка одной маски, что и у отчета без набора
+    QueryPlanResult seeded;
+    bool            ok = false;
+
+    try {
+        std::vector<ReportMarginLevel> margins;
+        const int code = server->GetMarginLevelByGroup(view->mask, &margins);
+        if (code != RET_OK && code != RET_OK_NONE) {
+            throw std::runtime_error("GetMarginLevelByGroup: return code " + std::to_string(code));
+        }
+        seeded = QueryPlanner::Execute(std::move(margins), nullptr, view->mask, server);
+        ok     = true;
+    } catch (const std::exception& e) {
+        std::cerr << "[MarginCallReportInterface]: margin call set seeding (" << view->mask
+                  << "): " << e.what() << std::endl;
+    }
+
+    std::vector<ReportEvent> pending;
+    bool                     reseeded = false;
+    size_t                   rows     = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        view->seeding = false;
+
+        // Reset(), событие группы или вытеснение во время заполнения: прочитанное уже устарело
+        if (!_active || _resets != start_resets || !CurrentLocked(view)) {
+            view->pending.clear();
+            return;
+        }
+
+        // Неудачная выборка: строкам больше нельзя верить, отчет берет выборку сам
+        if (!ok) {
+            _views.erase(view->mask);
+            ++_version;
+            return;
+        }
+
+        std::vector<MarginCallEntry> entries;
+        LoginIndex                   logins(seeded.entries.size());
+        entries.reserve(seeded.entries.size());
+        for (MarginCallEntry& entry : seeded.entries) {
+            // Повтор логина в ответе сервера: первая запись выигрывает
+            if (logins.Insert(entry.margin.login, static_cast<uint32_t>(entries.size()))) {
+                view->groups.emplace(entry.margin.group, true);
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        reseeded = view->seeded;
+        if (reseeded) {
+            MergeSeedLocked(*view, entries, logins);
+        } else {
+            view->entries = std::move(entries);
+            view->logins  = std::move(logins);
+            view->seeded  = true;
+            ++_version;
+            RestartChangesLocked(*view);
+        }
+        view->seed_ticket = ticket;
+        view->seeded_at   = std::chrono::steady_clock::now();
+        rows              = view->entries.size();
+
+        pending.reserve(view->pending.size());
+        for (const int login : view->pending) {
+            pending.push_back({EV_TYPE_ACCOUNT, EV_RECORD_UPDATE, login});
+        }
+        view->pending.clear();
+    }
+
+    RefreshLogins(pending, server);
+
+    std::cout << "[MarginCallReportInterface]: margin call set " << view->mask << " "
+              << (reseeded ? "re-seeded" : "seeded") << ", rows: " << rows
+              << ", re-read after seeding: " << pending.size() << std::endl;
+}
+
+bool MarginCallSet::ReseedDueLocked(const View& view) const {
+    return _reseed_interval.count() > 0 &&
+           std::chrono::steady_clock::now() - view.seeded_at >= _reseed_interval;
+}
+
+void MarginCallSet::MergeSeedLocked(View&                         view,
+                                    std::vector<MarginCallEntry>& entries,
+                                    LoginIndex&                   logins) {
+    // Изменения одной новой версией
+    std::vector<int> changes;
+
+    for (const MarginCallEntry& entry : view.entries) {
+        const uint32_t position = logins.Find(entry.margin.login);
+        if (position == LoginIndex::kNotFound || !SameRow(entry, entries[position])) {
+            changes.push_back(entry.margin.login);
+        }
+    }
+
+    for (const MarginCallEntry& seeded : entries) {
+        if (!view.logins.Contains(seeded.margin.login)) {
+            changes.push_back(seeded.margin.login);
+        }
+    }
+
+    if (!changes.empty()) {
+        ++_version;
+        for (const int login : changes) {
+            LogChangeLocked(view, login);
+        }
+    }
+
+    view.entries = std::move(entries);
+    view.logins  = std::move(logins);
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ReportServerInterface.h"
+#include "Structures.h"
+#include "structures/LoginIndex.hpp"
+#include "structures/ReportStructures.hpp"
+
+// Событие сервера, переданное плагину через EventReport
+struct ReportEvent {
+    EventType       type   = EV_TYPE_BALANCE;
+    EventRecordType record = EV_RECORD_UPDATE;
+    int             login  = 0;
+};
+
+struct EventsResult {
+    size_t applied = 0; // события, по которым аккаунт перечитан или набор сброшен
+    size_t ignored = 0; // типы, не влияющие на margin call, или события без логина
+};
+
+// Строки маски на версии набора и, если запрошено, их изменения после другой версии
+struct MarginCallSelection {
+    std::vector<MarginCallEntry> entries; // строки маски, в порядке набора
+    uint64_t                     version = 0;
+    bool                         delta   = false; // changed/removed покрывают всё после since
+    std::vector<uint32_t>        changed; // позиции в entries добавленных и измененных строк
+    std::vector<int>             removed; // логины строк, ушедших из маски
+};
+
+// Accounts currently in margin call or stop out, maintained from server events instead of
+// pulled on every CreateReport.
+//
+// The set becomes active with the first EventReport call and is kept per group mask (a view).
+// The first Select() for a mask seeds its view with the same GetMarginLevelByGroup(mask) pull
+// that CreateReport makes without the set, so no request pulls more than its own mask and the
+// server decides which accounts the mask covers. From then on balance, trade and account events
+// re-read only the affected login (GetAccountBalanceByLogin, GetAccountByLogin for new rows and
+// account changes) and add, update or drop its row in every view. A login joins a view only if
+// the server's MatchWildCardGroup(mask, group) says so; the answer is memoized per view until
+// EV_TYPE_GROUP. CreateReport then reads its mask in O(view size), which is the margin-call
+// population of the mask rather than the whole group.
+//
+// Every server read takes a ticket before it starts. A row is only overwritten by a read with a
+// newer ticket than the last one applied to its login and than the seed of the view, so two
+// events for the same login can not leave the older answer in the set. Logins touched by events
+// while a view is being seeded are re-read after it.
+//
+// Margin levels also move with quotes, which produce no account events: an account can cross
+// the margin call level, and rows keep equity and margin of their last event. So a view older
+// than the re-seed interval (MARGINCALL_SET_RESEED_MS, kDefaultReseedInterval if unset, 0 -
+// never) is pulled again by the next Select() for its mask; other requests keep reading its
+// current rows meanwhile, and the result is merged row by row into the change log. A failed
+// pull (exception or a return code other than RET_OK) drops the view and CreateReport pulls as
+// usual. At most kMaxViews masks are kept, the least recently selected one is dropped first.
+//
+// Every change of a row bumps the set version and goes into the bounded change log of its view
+// (kMaxChanges), so a client holding the version token of an earlier response can get only the
+// rows changed since then. Seeding a view, EV_TYPE_GROUP and Reset() start a new log; tokens
+// from before that, from another process or past the log are answered with the full table.
+class MarginCallSet {
+public:
+    static constexpr size_t kMaxChanges = 65536;
+    static constexpr size_t kMaxViews   = 64;
+
+    static constexpr std::chrono::milliseconds kDefaultReseedInterval{5000};
+
+    static MarginCallSet& Instance();
+
+    void Configure(std::chrono::milliseconds reseed_interval);
+
+    [[nodiscard]] bool Active() const;
+
+    EventsResult Apply(const std::vector<ReportEvent>& events, ReportServerInterface* server);
+
+    // Rows of the group_mask view, in view order, and with since - its changes after that
+    // version. false - the set is inactive, another request is seeding the view or the seeding
+    // pull failed; the caller then pulls as usual
+    bool Select(const std::string&      group_mask,
+                ReportServerInterface*  server,
+                MarginCallSelection&    selection,
+                std::optional<uint64_t> since = std::nullopt);
+
+    // "<epoch>-<version>": epoch отличает процесс плагина, токен чужого процесса не примется
+    [[nodiscard]] std::string VersionToken(uint64_t version) const;
+
+    [[nodiscard]] std::optional<uint64_t> ParseVersionToken(const std::string& token) const;
+
+    // EV_TYPE_GROUP: уровни margin call, валюты и состав групп могли измениться - все маски
+    // заполняются заново
+    void Invalidate();
+
+    // Drops the set and deactivates it (DestroyReport, {"reset": true} in EventReport)
+    void Reset();
+
+    // Растет при каждом изменении набора
+    [[nodiscard]] uint64_t Version() const;
+
+    // Строки всех заполненных масок
+    [[nodiscard]] size_t Size() const;
+
+    [[nodiscard]] size_t Views() const;
+
+    // Заполнена хотя бы одна маска
+    [[nodiscard]] bool Seeded() const;
+
+private:
+    MarginCallSet();
+
+    // Изменение строки маски на версии version
+    struct Change {
+        uint64_t version = 0;
+        int      login   = 0;
+    };
+
+    // Строки одной маски групп
+    struct View {
+        std::string                  mask;
+        bool                         seeded  = false;
+        bool                         seeding = false;
+        std::vector<MarginCallEntry> entries;
+        LoginIndex                   logins;
+        std::unordered_set<int>      pending; // логины событий, пришедших во время Seed
+
+        // MatchWildCardGroup(mask, group) сервера; группы строк заполнения - true
+        std::unordered_map<std::string, bool> groups;
+
+        uint64_t                              seed_ticket = 0; // строки не старше этого чтения
+        std::chrono::steady_clock::time_point seeded_at;
+        uint64_t                              used = 0; // для вытеснения давно не читанных
+
+        std::deque<Change> changes;
+        uint64_t           changes_base = 0; // журнал полон для since >= changes_base
+    };
+
+    // Итог перечитывания одного логина: строка для набора или ее отсутствие
+    struct Refresh {
+        int             login     = 0;
+        uint64_t        ticket    = 0;
+        bool            in_set    = false;
+        bool            keep_name = false; // name и group берутся из текущей строки
+        MarginCallEntry entry;
+    };
+
+    Refresh Read(const ReportEvent& event, ReportServerInterface* server);
+
+    void RefreshLogins(const std::vector<ReportEvent>& events, ReportServerInterface* server);
+
+    // Спрашивает сервер о группах, которых еще нет в groups своих представлений
+    void MatchGroups(const std::vector<std::pair<std::shared_ptr<View>, std::string>>& checks,
+                     ReportServerInterface*                                          server);
+
+    void ApplyLocked(View& view, const Refresh& refresh);
+
+    void InvalidateLocked();
+
+    // Представление еще в наборе: не вытеснено и не сброшено
+    [[nodiscard]] bool CurrentLocked(const std::shared_ptr<View>& view) const;
+
+    // Представление маски, новое - с вытеснением давно не читанного
+    std::shared_ptr<View> ViewLocked(const std::string& group_mask);
+
+    void LogChangeLocked(View& view, int login);
+
+    // Новый журнал: версии до текущей больше не восстановить
+    void RestartChangesLocked(View& view);
+
+    static void EraseLocked(View& view, int login);
+
+    void Seed(const std::shared_ptr<View>& view, ReportServerInterface* server);
+
+    // Представление заполнено раньше, чем _reseed_interval назад
+    [[nodiscard]] bool ReseedDueLocked(const View& view) const;
+
+    // Результат повторного заполнения вместо текущих строк: отличия идут в журнал изменений
+    void MergeSeedLocked(View& view, std::vector<MarginCallEntry>& entries, LoginIndex& logins);
+
+    mutable std::mutex _mutex;
+    bool               _active  = false;
+    uint64_t           _version = 0;
+    uint64_t           _resets  = 0; // Invalidate/Reset: идущий Seed уже устарел
+    uint64_t           _uses    = 0;
+
+    std::unordered_map<std::string, std::shared_ptr<View>> _views;
+
+    // Последнее примененное чтение логина: более раннее его уже не перезапишет
+    uint64_t                          _tickets = 0;
+    std::unordered_map<int, uint64_t> _applied;
+
+    std::chrono::milliseconds _reseed_interval = kDefaultReseedInterval;
+    uint64_t                  _epoch           = 0;
+};
@@ -0,0 +1,59 @@
+#include "Executor.h"
+
+#include <algorithm>
+
+Executor& Executor::Instance() {
+    // Не разрушается: при выгрузке библиотеки потоки уже остановлены DestroyReport
+    static Executor* executor = new Executor(
+        std::max(kMinThreadsCount, kThreadsPerCore * std::thread::hardware_concurrency()));
+    return *executor;
+}
+
+void Executor::Shutdown() {
+    std::vector<std::thread> workers;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        workers.swap(_workers);
+    }
+
+    _condition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void Executor::GrowLocked() {
+    if (_tasks.size() <= _idle || _workers.size() >= _threads_count) {
+        return;
+    }
+
+    _workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+void Executor::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_idle;
+            _condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+            --_idle;
+
+            // При остановке сначала дорабатываем очередь
+            if (_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Thread pool owned by the plugin, sized to the host: kThreadsPerCore workers per hardware thread
+// (at least kMinThreadsCount), since the tasks are blocking server calls and every CreateReport
+// submits up to three of them. A worker is started when a task finds no idle one, and all are
+// joined by Shutdown() (called from DestroyReport). Shutdown is final: later tasks run on the
+// calling thread.
+//
+// The pool is never destroyed, so no worker is joined during static destruction.
+class Executor {
+public:
+    static constexpr size_t kMinThreadsCount = 3;
+    static constexpr size_t kThreadsPerCore  = 2;
+
+    static Executor& Instance();
+
+    template <typename Fn>
+    auto Submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_stopping) {
+                _tasks.emplace_back([task]() { (*task)(); });
+                GrowLocked();
+                queued = true;
+            }
+        }
+
+        if (queued) {
+            _condition.notify_one();
+        } else {
+            // После Shutdown() потоков нет: задача выполняется в вызывающем потоке
+            (*task)();
+        }
+        return future;
+    }
+
+    // Finishes queued tasks and joins the workers
+    void Shutdown();
+
+private:
+    explicit Executor(size_t threads_count) : _threads_count(threads_count) {}
+
+    // Новый поток, если задач в очереди больше, чем ждущих потоков, и предел не достигнут
+    void GrowLocked();
+
+    void WorkerLoop();
+
+    size_t                            _threads_count;
+    std::mutex                        _mutex;
+    std::condition_variable           _condition;
+    std::deque<std::function<void()>> _tasks;
+    std::vector<std::thread>          _workers;
+    size_t                            _idle     = 0;
+    bool                              _stopping = false;
+};
@@ -0,0 +1,117 @@
+#include "DataFetcher.h"
+
+#include <chrono>
+#include <stdexcept>
+
+#include "executors/Executor.h"
+
+namespace {
+    // Код ошибки сервера - такой же отказ вызова, как исключение
+    void CheckReturnCode(const int code) {
+        if (code != RET_OK && code != RET_OK_NONE) {
+            throw std::runtime_error("return code " + std::to_string(code));
+        }
+    }
+} // namespace
+
+FetchStageResult DataFetcher::Fetch(const std::string&     group_mask,
+                                    ReportServerInterface* server,
+                                    bool                   prefetch_accounts) {
+    auto groups_future = Submit<ReportGroupRecord>(
+        "GetAllGroups", [server](std::vector<ReportGroupRecord>* groups) {
+            CheckReturnCode(server->GetAllGroups(groups));
+        });
+
+    auto margins_future = Submit<ReportMarginLevel>(
+        "GetMarginLevelByGroup", [server, group_mask](std::vector<ReportMarginLevel>* margins) {
+            CheckReturnCode(server->GetMarginLevelByGroup(group_mask, margins));
+        });
+
+    std::future<FetchResult<ReportAccountRecord>> accounts_future;
+    if (prefetch_accounts) {
+        accounts_future = Submit<ReportAccountRecord>(
+            "GetAccountsByGroup",
+            [server, group_mask](std::vector<ReportAccountRecord>* accounts) {
+                CheckReturnCode(server->GetAccountsByGroup(group_mask, accounts));
+            });
+    }
+
+    FetchStageResult result;
+    result.groups  = groups_future.get();
+    result.margins = margins_future.get();
+
+    if (accounts_future.valid()) {
+        result.accounts = accounts_future.get();
+    }
+
+    return result;
+}
+
+void DataFetcher::LogLatencies(const FetchStageResult& result) {
+    LogLatency("GetAllGroups", result.groups);
+    LogLatency("GetMarginLevelByGroup", result.margins);
+    LogLatency("GetAccountsByGroup", result.accounts);
+}
+
+void DataFetcher::RecordSpans(const FetchStageResult& result, ReportTrace& trace) {
+    RecordSpan(ReportStage::FetchGroups, result.groups, trace);
+    RecordSpan(ReportStage::FetchMargins, result.margins, trace);
+    RecordSpan(ReportStage::FetchAccounts, result.accounts, trace);
+}
+
+template <typename T, typename Call>
+std::future<FetchResult<T>> DataFetcher::Submit(const char* name, Call call) {
+    return Executor::Instance().Submit([name, call]() {
+        FetchResult<T> result;
+        result.requested = true;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        try {
+            call(&result.rows);
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.rows.clear();
+            result.error = e.what();
+        } catch (...) {
+            result.rows.clear();
+            result.error = std::string(name) + ": unknown error";
+        }
+
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        result.latency_ms = elapsed.count();
+
+        return result;
+    });
+}
+
+template <typename T>
+void DataFetcher::RecordSpan(const ReportStage     stage,
+                             const FetchResult<T>& result,
+                             ReportTrace&          trace) {
+    if (!result.requested) {
+        return;
+    }
+
+    trace.Record(stage,
+                 static_cast<uint64_t>(result.latency_ms * 1e6),
+                 result.rows.size(),
+                 result.rows.size() * sizeof(T));
+}
+
+template <typename T>
+void DataFetcher::LogLatency(const char* name, const FetchResult<T>& result) {
+    if (!result.requested) {
+        return;
+    }
+
+    if (!result.ok) {
+        std::cerr << "[MarginCallReportInterface]: " << name << " failed in " << result.latency_ms
+                  << " ms: " << result.error << std::endl;
+        return;
+    }
+
+    std::cout << "[MarginCallReportInterface]: " << name << ": " << result.rows.size()
+              << " rows in " << result.latency_ms << " ms" << std::endl;
+}
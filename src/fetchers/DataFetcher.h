@@ -0,0 +1,49 @@
+#pragma once
+
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ReportServerInterface.h"
+#include "metrics/ReportMetrics.h"
+
+// Результат одного вызова сервера
+template <typename T>
+struct FetchResult {
+    std::vector<T> rows;
+    bool           requested  = false;
+    bool           ok         = false;
+    std::string    error;
+    double         latency_ms = 0.0;
+};
+
+struct FetchStageResult {
+    FetchResult<ReportGroupRecord>   groups;
+    FetchResult<ReportMarginLevel>   margins;
+    FetchResult<ReportAccountRecord> accounts; // requested only when a full scan is expected
+};
+
+// Issues the independent server calls of CreateReport concurrently on the plugin Executor.
+// Every call is isolated: a failed call is reported in its own FetchResult, the others are kept.
+class DataFetcher {
+public:
+    static FetchStageResult Fetch(const std::string&     group_mask,
+                                  ReportServerInterface* server,
+                                  bool                   prefetch_accounts);
+
+    static void LogLatencies(const FetchStageResult& result);
+
+    // Requested calls become fetch spans: latency, rows and the size of the fetched records
+    static void RecordSpans(const FetchStageResult& result, ReportTrace& trace);
+
+private:
+    template <typename T, typename Call>
+    static std::future<FetchResult<T>> Submit(const char* name, Call call);
+
+    template <typename T>
+    static void RecordSpan(ReportStage stage, const FetchResult<T>& result, ReportTrace& trace);
+
+    template <typename T>
+    static void LogLatency(const char* name, const FetchResult<T>& result);
+};
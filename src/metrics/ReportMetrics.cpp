@@ -0,0 +1,135 @@
+#include "ReportMetrics.h"
+
+using rapidjson::kObjectType;
+using rapidjson::StringRef;
+using rapidjson::Value;
+
+namespace {
+    double ToMilliseconds(const uint64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+} // namespace
+
+const char* ReportStageName(const ReportStage stage) {
+    switch (stage) {
+        case ReportStage::Validation: return "validation";
+        case ReportStage::FetchGroups: return "fetch_groups";
+        case ReportStage::FetchMargins: return "fetch_margins";
+        case ReportStage::FetchAccounts: return "fetch_accounts";
+        case ReportStage::JoinFilter: return "join_filter";
+        case ReportStage::TableBuild: return "table_build";
+        case ReportStage::JsonConversion: return "json_conversion";
+        case ReportStage::CreateUI: return "create_ui";
+        case ReportStage::Total: return "total";
+        case ReportStage::Count: break;
+    }
+    return "unknown";
+}
+
+void ReportTrace::ScopedSpan::Stop() {
+    if (_stopped) {
+        return;
+    }
+    _stopped = true;
+
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+    _trace.Record(_stage, static_cast<uint64_t>(elapsed), _rows, _bytes);
+}
+
+void ReportTrace::Record(const ReportStage stage,
+                         const uint64_t    duration_ns,
+                         const uint64_t    rows,
+                         const uint64_t    bytes) {
+    _spans[static_cast<size_t>(stage)] = {duration_ns, rows, bytes, true};
+}
+
+void ReportTrace::WriteTo(Value& out, rapidjson::Document::AllocatorType& allocator) const {
+    out.SetObject();
+
+    for (size_t i = 0; i < kReportStagesCount; ++i) {
+        const StageSpan& span = _spans[i];
+        if (!span.recorded) {
+            continue;
+        }
+
+        Value stage(kObjectType);
+        stage.AddMember("ms", ToMilliseconds(span.duration_ns), allocator);
+        stage.AddMember("rows", span.rows, allocator);
+        stage.AddMember("bytes", span.bytes, allocator);
+
+        out.AddMember(StringRef(ReportStageName(static_cast<ReportStage>(i))), stage, allocator);
+    }
+}
+
+ReportMetrics& ReportMetrics::Instance() {
+    static ReportMetrics metrics;
+    return metrics;
+}
+
+void ReportMetrics::Add(const ReportTrace& trace) {
+    _requests.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < kReportStagesCount; ++i) {
+        const StageSpan& span = trace.Get(static_cast<ReportStage>(i));
+        if (!span.recorded) {
+            continue;
+        }
+
+        StageCounters& counters = _stages[i];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.total_ns.fetch_add(span.duration_ns, std::memory_order_relaxed);
+        counters.last_ns.store(span.duration_ns, std::memory_order_relaxed);
+        counters.rows.fetch_add(span.rows, std::memory_order_relaxed);
+        counters.bytes.fetch_add(span.bytes, std::memory_order_relaxed);
+
+        uint64_t max_ns = counters.max_ns.load(std::memory_order_relaxed);
+        while (span.duration_ns > max_ns &&
+               !counters.max_ns.compare_exchange_weak(max_ns, span.duration_ns,
+                                                      std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void ReportMetrics::WriteTo(Value& out, rapidjson::Document::AllocatorType& allocator) const {
+    out.SetObject();
+    out.AddMember("requests", _requests.load(std::memory_order_relaxed), allocator);
+
+    Value stages(kObjectType);
+    for (size_t i = 0; i < kReportStagesCount; ++i) {
+        const StageCounters& counters = _stages[i];
+
+        const uint64_t count    = counters.count.load(std::memory_order_relaxed);
+        const uint64_t total_ns = counters.total_ns.load(std::memory_order_relaxed);
+
+        Value stage(kObjectType);
+        stage.AddMember("count", count, allocator);
+        stage.AddMember("total_ms", ToMilliseconds(total_ns), allocator);
+        stage.AddMember("avg_ms", count == 0 ? 0.0 : ToMilliseconds(total_ns) / count, allocator);
+        stage.AddMember("max_ms", ToMilliseconds(counters.max_ns.load(std::memory_order_relaxed)),
+                        allocator);
+        stage.AddMember("last_ms",
+                        ToMilliseconds(counters.last_ns.load(std::memory_order_relaxed)),
+                        allocator);
+        stage.AddMember("rows", counters.rows.load(std::memory_order_relaxed), allocator);
+        stage.AddMember("bytes", counters.bytes.load(std::memory_order_relaxed), allocator);
+
+        stages.AddMember(StringRef(ReportStageName(static_cast<ReportStage>(i))), stage,
+                         allocator);
+    }
+
+    out.AddMember("stages", stages, allocator);
+}
+
+void ReportMetrics::Reset() {
+    _requests.store(0, std::memory_order_relaxed);
+
+    for (StageCounters& counters : _stages) {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.total_ns.store(0, std::memory_order_relaxed);
+        counters.max_ns.store(0, std::memory_order_relaxed);
+        counters.last_ns.store(0, std::memory_order_relaxed);
+        counters.rows.store(0, std::memory_order_relaxed);
+        counters.bytes.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "rapidjson/document.h"
+
+// Этапы CreateReport. Запросы к серверу выполняются параллельно, их интервалы пересекаются.
+enum class ReportStage : uint8_t {
+    Validation,
+    FetchGroups,
+    FetchMargins,
+    FetchAccounts,
+    JoinFilter,
+    TableBuild,
+    JsonConversion,
+    CreateUI,
+    Total,
+    Count
+};
+
+inline constexpr size_t kReportStagesCount = static_cast<size_t>(ReportStage::Count);
+
+const char* ReportStageName(ReportStage stage);
+
+struct StageSpan {
+    uint64_t duration_ns = 0;
+    uint64_t rows        = 0;
+    uint64_t bytes       = 0; // fetches: size of the records, JSON stages: allocator growth
+    bool     recorded    = false;
+};
+
+// Spans of a single CreateReport call, measured with the monotonic clock.
+class ReportTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Записывает интервал от создания до Stop() или деструктора
+    class ScopedSpan {
+    public:
+        ScopedSpan(ReportTrace& trace, ReportStage stage)
+            : _trace(trace), _stage(stage), _start(Clock::now()) {}
+
+        ScopedSpan(const ScopedSpan&)            = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+        ~ScopedSpan() { Stop(); }
+
+        void SetRows(const uint64_t rows) { _rows = rows; }
+        void SetBytes(const uint64_t bytes) { _bytes = bytes; }
+
+        void Stop();
+
+    private:
+        ReportTrace&      _trace;
+        ReportStage       _stage;
+        Clock::time_point _start;
+        uint64_t          _rows    = 0;
+        uint64_t          _bytes   = 0;
+        bool              _stopped = false;
+    };
+
+    ScopedSpan Span(const ReportStage stage) { return {*this, stage}; }
+
+    void Record(ReportStage stage, uint64_t duration_ns, uint64_t rows, uint64_t bytes);
+
+    [[nodiscard]] const StageSpan& Get(ReportStage stage) const {
+        return _spans[static_cast<size_t>(stage)];
+    }
+
+    // {"validation": {"ms", "rows", "bytes"}, ...} - только записанные этапы
+    void WriteTo(rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) const;
+
+private:
+    std::array<StageSpan, kReportStagesCount> _spans{};
+};
+
+// Process-wide aggregate of all traces, read through the StatsReport entry point.
+// Lock-free: CreateReport may run concurrently on several host threads.
+class ReportMetrics {
+public:
+    static ReportMetrics& Instance();
+
+    void Add(const ReportTrace& trace);
+
+    // {"requests": N, "stages": {"validation": {"count", "total_ms", "avg_ms", "max_ms",
+    //  "last_ms", "rows", "bytes"}, ...}}
+    void WriteTo(rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) const;
+
+    void Reset();
+
+private:
+    struct StageCounters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> last_ns{0};
+        std::atomic<uint64_t> rows{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    ReportMetrics() = default;
+
+    std::atomic<uint64_t>                         _requests{0};
+    std::array<StageCounters, kReportStagesCount> _stages;
+};
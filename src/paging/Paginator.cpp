@@ -0,0 +1,255 @@
+#include "Paginator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string_view>
+
+namespace {
+    struct SortKey {
+        double           number = 0.0;
+        std::string_view string;
+        int              login = 0;
+    };
+
+    template <typename T>
+    int Compare(const T& lhs, const T& rhs) {
+        return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+    }
+
+    // NaN (например, уровень маржи без маржи) меньше любого числа и равен другому NaN: иначе
+    // порядок не строгий слабый и partial_sort ведет себя неопределенно
+    int CompareNumbers(const double lhs, const double rhs) {
+        const bool lhs_nan = std::isnan(lhs);
+        const bool rhs_nan = std::isnan(rhs);
+        if (lhs_nan || rhs_nan) {
+            return Compare(rhs_nan, lhs_nan);
+        }
+        return Compare(lhs, rhs);
+    }
+
+    bool EqualsIgnoreCase(const std::string_view lhs, const std::string_view rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](char l, char r) {
+            return std::tolower(static_cast<unsigned char>(l)) ==
+                   std::tolower(static_cast<unsigned char>(r));
+        });
+    }
+
+    // Порядок вывода строк: колонка сортировки, при равенстве - логин в том же направлении
+    struct RowOrder {
+        bool is_string  = false;
+        bool descending = true;
+
+        bool operator()(const SortKey& lhs, const SortKey& rhs) const {
+            int result = is_string ? Compare(lhs.string, rhs.string)
+                                   : CompareNumbers(lhs.number, rhs.number);
+            if (result == 0) {
+                result = Compare(lhs.login, rhs.login);
+            }
+            return descending ? result > 0 : result < 0;
+        }
+    };
+} // namespace
+
+PageRequest Paginator::Parse(const rapidjson::Value& request) {
+    PageRequest page_request;
+
+    if (!request.HasMember("limit") || !request["limit"].IsInt64() ||
+        request["limit"].GetInt64() <= 0) {
+        return page_request;
+    }
+
+    page_request.enabled = true;
+    page_request.limit   = static_cast<size_t>(
+        std::min<int64_t>(request["limit"].GetInt64(), static_cast<int64_t>(kMaxLimit)));
+
+    if (request.HasMember("offset") && request["offset"].IsInt64() &&
+        request["offset"].GetInt64() > 0) {
+        page_request.offset = static_cast<size_t>(request["offset"].GetInt64());
+    } else if (request.HasMember("page") && request["page"].IsInt64() &&
+               request["page"].GetInt64() > 1) {
+        // (page - 1) * limit без переполнения: за последней строкой страница все равно пустая
+        const auto pages    = static_cast<size_t>(request["page"].GetInt64() - 1);
+        page_request.offset = pages > SIZE_MAX / page_request.limit ? SIZE_MAX
+                                                                    : pages * page_request.limit;
+    }
+
+    if (request.HasMember("order_by") && request["order_by"].IsString()) {
+        if (const auto column = ParseColumn(request["order_by"].GetString())) {
+            page_request.column = *column;
+        }
+    }
+
+    if (request.HasMember("order") && request["order"].IsString()) {
+        page_request.descending = !EqualsIgnoreCase(request["order"].GetString(), "ASC");
+    }
+
+    if (request.HasMember("cursor") && request["cursor"].IsString()) {
+        page_request.cursor = ParseCursor(request["cursor"].GetString());
+    }
+
+    return page_request;
+}
+
+PageResult Paginator::SelectPage(const std::vector<MarginCallEntry>& entries,
+                                 const std::vector<CurrencyId>&      currency_ids,
+                                 const GroupIndex&                   group_index,
+                                 const PageRequest&                  page_request) {
+    PageResult result;
+    result.total = entries.size();
+
+    if (!page_request.enabled) {
+        result.positions.resize(entries.size());
+        std::iota(result.positions.begin(), result.positions.end(), 0u);
+        return result;
+    }
+
+    const SortColumn column    = page_request.column;
+    const bool       is_string = IsStringColumn(column);
+    const RowOrder   order{is_string, page_request.descending};
+
+    const auto key_of = [&](const uint32_t position) {
+        const MarginCallEntry& entry = entries[position];
+
+        SortKey key;
+        key.login = entry.margin.login;
+
+        if (column == SortColumn::Name) {
+            key.string = entry.name;
+        } else if (column == SortColumn::Currency) {
+            key.string = group_index.GetCurrencyName(currency_ids[position]);
+        } else {
+            key.number = NumberValue(entry, column);
+        }
+        return key;
+    };
+
+    // Keyset: оставляем только строки после курсора
+    std::vector<uint32_t> candidates;
+    candidates.reserve(entries.size());
+
+    if (page_request.cursor) {
+        const SortKey cursor_key{page_request.cursor->number_value,
+                                 page_request.cursor->string_value,
+                                 page_request.cursor->login};
+
+        for (uint32_t position = 0; position < entries.size(); ++position) {
+            if (order(cursor_key, key_of(position))) {
+                candidates.push_back(position);
+            }
+        }
+    } else {
+        candidates.resize(entries.size());
+        std::iota(candidates.begin(), candidates.end(), 0u);
+    }
+
+    const size_t skip = page_request.cursor ? 0 : page_request.offset;
+    result.offset     = entries.size() - candidates.size() + skip;
+
+    if (skip >= candidates.size()) {
+        return result;
+    }
+
+    // Частичная сортировка: упорядочиваем только skip + limit первых строк. limit сначала
+    // ограничен оставшимися строками, чтобы skip + limit не переполнился
+    const size_t limit      = std::min(page_request.limit, candidates.size() - skip);
+    const size_t window_end = skip + limit;
+    std::partial_sort(candidates.begin(),
+                      candidates.begin() + static_cast<std::ptrdiff_t>(window_end),
+                      candidates.end(),
+                      [&](const uint32_t lhs, const uint32_t rhs) {
+                          return order(key_of(lhs), key_of(rhs));
+                      });
+
+    result.positions.assign(candidates.begin() + static_cast<std::ptrdiff_t>(skip),
+                            candidates.begin() + static_cast<std::ptrdiff_t>(window_end));
+    result.has_more = window_end < candidates.size();
+
+    if (result.has_more) {
+        const SortKey last = key_of(result.positions.back());
+
+        if (is_string) {
+            result.next_cursor = std::to_string(last.login) + ":" + std::string(last.string);
+        } else {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", last.number);
+            result.next_cursor = std::to_string(last.login) + ":" + buffer;
+        }
+    }
+
+    return result;
+}
+
+const char* Paginator::ColumnKey(const SortColumn column) {
+    switch (column) {
+        case SortColumn::Login: return "login";
+        case SortColumn::Name: return "name";
+        case SortColumn::Leverage: return "leverage";
+        case SortColumn::Balance: return "balance";
+        case SortColumn::Credit: return "credit";
+        case SortColumn::FloatingPl: return "floating_pl";
+        case SortColumn::Equity: return "equity";
+        case SortColumn::Margin: return "margin";
+        case SortColumn::MarginFree: return "margin_free";
+        case SortColumn::MarginLevel: return "margin_level";
+        case SortColumn::Currency: return "currency";
+    }
+    return "login";
+}
+
+std::optional<SortColumn> Paginator::ParseColumn(const std::string& key) {
+    for (const SortColumn column : {SortColumn::Login,
+                                    SortColumn::Name,
+                                    SortColumn::Leverage,
+                                    SortColumn::Balance,
+                                    SortColumn::Credit,
+                                    SortColumn::FloatingPl,
+                                    SortColumn::Equity,
+                                    SortColumn::Margin,
+                                    SortColumn::MarginFree,
+                                    SortColumn::MarginLevel,
+                                    SortColumn::Currency}) {
+        if (key == ColumnKey(column)) {
+            return column;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<PageCursor> Paginator::ParseCursor(const std::string& cursor) {
+    const size_t separator = cursor.find(':');
+    if (separator == std::string::npos || separator == 0) {
+        return std::nullopt;
+    }
+
+    PageCursor page_cursor;
+    page_cursor.login        = std::atoi(cursor.substr(0, separator).c_str());
+    page_cursor.string_value = cursor.substr(separator + 1);
+    page_cursor.number_value = std::strtod(page_cursor.string_value.c_str(), nullptr);
+    return page_cursor;
+}
+
+bool Paginator::IsStringColumn(const SortColumn column) {
+    return column == SortColumn::Name || column == SortColumn::Currency;
+}
+
+double Paginator::NumberValue(const MarginCallEntry& entry, const SortColumn column) {
+    const ReportMarginLevel& margin_level = entry.margin;
+
+    switch (column) {
+        case SortColumn::Login: return margin_level.login;
+        case SortColumn::Leverage: return margin_level.leverage;
+        case SortColumn::Balance: return margin_level.balance;
+        case SortColumn::Credit: return margin_level.credit;
+        case SortColumn::FloatingPl: return margin_level.equity - margin_level.balance;
+        case SortColumn::Equity: return margin_level.equity;
+        case SortColumn::Margin: return margin_level.margin;
+        case SortColumn::MarginFree: return margin_level.margin_free;
+        case SortColumn::MarginLevel: return margin_level.margin_level;
+        default: return 0.0;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "structures/GroupIndex.h"
+#include "structures/ReportStructures.hpp"
+
+// Колонки, по которым возможна серверная сортировка
+enum class SortColumn {
+    Login,
+    Name,
+    Leverage,
+    Balance,
+    Credit,
+    FloatingPl,
+    Equity,
+    Margin,
+    MarginFree,
+    MarginLevel,
+    Currency
+};
+
+// Keyset cursor: sort value and login of the last row of the previous page
+struct PageCursor {
+    int         login        = 0;
+    double      number_value = 0.0;
+    std::string string_value;
+};
+
+// Paging parameters of the request:
+//   "limit"    - page size, paging is disabled without it; capped at Paginator::kMaxLimit
+//   "offset"   - rows to skip, or "page" - 1-based page number
+//   "cursor"   - "nextCursor" of the previous page, takes precedence over offset/page
+//   "order_by" - column key, "order" - "ASC" / "DESC" (any case)
+struct PageRequest {
+    bool                      enabled    = false;
+    size_t                    offset     = 0;
+    size_t                    limit      = 0;
+    SortColumn                column     = SortColumn::Login;
+    bool                      descending = true;
+    std::optional<PageCursor> cursor;
+};
+
+struct PageResult {
+    std::vector<uint32_t> positions;        // entries of the page, in output order
+    size_t                total    = 0;     // rows in the full margin call set
+    size_t                offset   = 0;     // position of the first page row in the sorted set
+    bool                  has_more = false;
+    std::string           next_cursor;
+};
+
+class Paginator {
+public:
+    // Больше строк на странице не бывает: TableBuilder::SetLimit принимает int
+    static constexpr size_t kMaxLimit = std::numeric_limits<int>::max();
+
+    static PageRequest Parse(const rapidjson::Value& request);
+
+    // Without paging all entries are returned in their original order.
+    // currency_ids - currency of each entry, used by the currency sort
+    static PageResult SelectPage(const std::vector<MarginCallEntry>& entries,
+                                 const std::vector<CurrencyId>&      currency_ids,
+                                 const GroupIndex&                   group_index,
+                                 const PageRequest&                  page_request);
+
+    static const char* ColumnKey(SortColumn column);
+
+private:
+    static std::optional<SortColumn> ParseColumn(const std::string& key);
+
+    static std::optional<PageCursor> ParseCursor(const std::string& cursor);
+
+    static bool IsStringColumn(SortColumn column);
+
+    static double NumberValue(const MarginCallEntry& entry, SortColumn column);
+};
@@ -0,0 +1,168 @@
+#include "QueryPlanner.h"
+
+#include <algorithm>
+
+#include "structures/LoginIndex.hpp"
+
+QueryPlan QueryPlanner::ChoosePlan(size_t scanned_rows, size_t selected_rows) {
+    if (selected_rows == 0) {
+        return QueryPlan::MarginLevelFirst;
+    }
+
+    const double selectivity =
+        static_cast<double>(selected_rows) / static_cast<double>(std::max<size_t>(scanned_rows, 1));
+
+    if (selected_rows <= kMaxPointLookupRows && selectivity <= kMaxPointLookupSelectivity) {
+        return QueryPlan::MarginLevelFirst;
+    }
+
+    return QueryPlan::FullScan;
+}
+
+QueryPlanResult QueryPlanner::Execute(std::vector<ReportMarginLevel>    margins,
+                                      std::vector<ReportAccountRecord>* prefetched_accounts,
+                                      const std::string&                group_mask,
+                                      ReportServerInterface*            server) {
+    QueryPlanResult result;
+
+    result.scanned_rows = margins.size();
+
+    // Оставляем только аккаунты в margin call / stop out
+    margins.erase(std::remove_if(margins.begin(),
+                                 margins.end(),
+                                 [](const ReportMarginLevel& margin_level) {
+                                     return !IsMarginCall(margin_level);
+                                 }),
+                  margins.end());
+
+    result.selectivity = result.scanned_rows == 0 ? 0.0
+                                                  : static_cast<double>(margins.size()) /
+                                                        static_cast<double>(result.scanned_rows);
+    result.selected_rows = margins.size();
+    result.plan          = ChoosePlan(result.scanned_rows, margins.size());
+
+    if (margins.empty()) {
+        return result;
+    }
+
+    result.entries.reserve(margins.size());
+
+    // Уже полученные аккаунты дешевле соединить, чем делать запросы по логинам
+    if (prefetched_accounts != nullptr) {
+        result.plan = QueryPlan::FullScan;
+        ResolveByScan(margins, *prefetched_accounts, result.entries);
+    } else if (result.plan == QueryPlan::MarginLevelFirst) {
+        ResolveByLogin(margins, server, result.entries);
+    } else {
+        std::vector<ReportAccountRecord> accounts;
+        server->GetAccountsByGroup(group_mask, &accounts);
+        ResolveByScan(margins, accounts, result.entries);
+    }
+
+    return result;
+}
+
+void QueryPlanner::Remember(const std::string& group_mask, const QueryPlanResult& result) {
+    std::lock_guard<std::mutex> lock(_statistics_mutex);
+
+    // Маски приходят из запросов: без предела карта росла бы без конца
+    if (_statistics.size() >= kMaxTrackedMasks && !_statistics.contains(group_mask)) {
+        _statistics.clear();
+    }
+    _statistics[group_mask] = {result.scanned_rows, result.selected_rows};
+}
+
+double QueryPlanner::LastSelectivity(const std::string& group_mask) {
+    const std::optional<MaskStatistics> statistics = FindStatistics(group_mask);
+    if (!statistics) {
+        return -1.0;
+    }
+    return statistics->scanned_rows == 0 ? 0.0
+                                         : static_cast<double>(statistics->selected_rows) /
+                                               static_cast<double>(statistics->scanned_rows);
+}
+
+bool QueryPlanner::ShouldPrefetchAccounts(const std::string& group_mask) {
+    // То же решение, что и у ChoosePlan: и по selectivity, и по числу строк
+    const std::optional<MaskStatistics> statistics = FindStatistics(group_mask);
+    return statistics &&
+           ChoosePlan(statistics->scanned_rows, statistics->selected_rows) == QueryPlan::FullScan;
+}
+
+std::optional<QueryPlanner::MaskStatistics> QueryPlanner::FindStatistics(
+    const std::string& group_mask) {
+    std::lock_guard<std::mutex> lock(_statistics_mutex);
+
+    const auto it = _statistics.find(group_mask);
+    if (it == _statistics.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const char* QueryPlanner::PlanName(QueryPlan plan) {
+    switch (plan) {
+        case QueryPlan::MarginLevelFirst: return "margin-level-first";
+        case QueryPlan::FullScan: return "full-scan";
+    }
+    return "unknown";
+}
+
+bool QueryPlanner::IsMarginCall(const ReportMarginLevel& margin_level) {
+    return margin_level.level_type == MARGINLEVEL_MARGINCALL ||
+           margin_level.level_type == MARGINLEVEL_STOPOUT;
+}
+
+void QueryPlanner::ResolveByLogin(std::vector<ReportMarginLevel>& margins,
+                                  ReportServerInterface*          server,
+                                  std::vector<MarginCallEntry>&   entries) {
+    for (auto& margin_level : margins) {
+        ReportAccountRecord account;
+
+        try {
+            server->GetAccountByLogin(margin_level.login, &account);
+        } catch (const std::exception& e) {
+            std::cerr << "[MarginCallReportInterface]: GetAccountByLogin(" << margin_level.login
+                      << "): " << e.what() << std::endl;
+            continue;
+        }
+
+        // Аккаунт не найден - как и при полном сканировании, строку не показываем
+        if (account.login != margin_level.login) {
+            continue;
+        }
+
+        if (margin_level.group.empty()) {
+            margin_level.group = std::move(account.group);
+        }
+
+        entries.push_back({std::move(margin_level), std::move(account.name)});
+    }
+}
+
+void QueryPlanner::ResolveByScan(std::vector<ReportMarginLevel>&   margins,
+                                 std::vector<ReportAccountRecord>& accounts,
+                                 std::vector<MarginCallEntry>&     entries) {
+    LoginIndex margin_index(margins.size());
+
+    for (size_t i = 0; i < margins.size(); ++i) {
+        margin_index.Insert(margins[i].login, static_cast<uint32_t>(i));
+    }
+
+    std::vector<bool> joined(margins.size(), false);
+
+    for (auto& account : accounts) {
+        const uint32_t position = margin_index.Find(account.login);
+        if (position == LoginIndex::kNotFound || joined[position]) {
+            continue;
+        }
+
+        joined[position]                = true;
+        ReportMarginLevel& margin_level = margins[position];
+        if (margin_level.group.empty()) {
+            margin_level.group = std::move(account.group);
+        }
+
+        entries.push_back({std::move(margin_level), std::move(account.name)});
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ReportServerInterface.h"
+#include "structures/ReportStructures.hpp"
+
+// Способ получения данных аккаунтов для отчета
+enum class QueryPlan {
+    MarginLevelFirst, // margin levels first, account details resolved per login
+    FullScan          // all accounts of the group joined with margin levels
+};
+
+struct QueryPlanResult {
+    QueryPlan                    plan         = QueryPlan::FullScan;
+    double                       selectivity   = 0.0; // selected rows / margin level rows
+    size_t                       scanned_rows  = 0;   // margin level rows received from server
+    size_t                       selected_rows = 0;   // margin call rows among them
+    std::vector<MarginCallEntry> entries;
+};
+
+class QueryPlanner {
+public:
+    // Point lookups are only cheaper than one bulk GetAccountsByGroup while few rows survive
+    static constexpr double kMaxPointLookupSelectivity = 0.05;
+    static constexpr size_t kMaxPointLookupRows        = 4096;
+
+    // Сколько масок групп помнят свой последний план; при переполнении память сбрасывается
+    static constexpr size_t kMaxTrackedMasks = 1024;
+
+    static QueryPlan ChoosePlan(size_t scanned_rows, size_t selected_rows);
+
+    // prefetched_accounts - result of GetAccountsByGroup if it was already fetched, else nullptr.
+    // Does not touch the per-mask statistics: the report path passes its result to Remember
+    static QueryPlanResult Execute(std::vector<ReportMarginLevel>    margins,
+                                   std::vector<ReportAccountRecord>* prefetched_accounts,
+                                   const std::string&                group_mask,
+                                   ReportServerInterface*            server);
+
+    // Statistics of a report for group_mask, for the next ShouldPrefetchAccounts
+    static void Remember(const std::string& group_mask, const QueryPlanResult& result);
+
+    // Selectivity of the last remembered report for group_mask, -1 if there was none
+    static double LastSelectivity(const std::string& group_mask);
+
+    // ChoosePlan picked a full scan for the last report of group_mask, so GetAccountsByGroup is
+    // worth fetching up front. Masks select different groups, so one mask's answer says nothing
+    // about another
+    static bool ShouldPrefetchAccounts(const std::string& group_mask);
+
+    static const char* PlanName(QueryPlan plan);
+
+    static bool IsMarginCall(const ReportMarginLevel& margin_level);
+
+private:
+    // Последний отчет маски: из него ChoosePlan повторяется без новой выборки
+    struct MaskStatistics {
+        size_t scanned_rows  = 0;
+        size_t selected_rows = 0;
+    };
+
+    static inline std::mutex                                      _statistics_mutex;
+    static inline std::unordered_map<std::string, MaskStatistics> _statistics;
+
+    static std::optional<MaskStatistics> FindStatistics(const std::string& group_mask);
+
+    static void ResolveByLogin(std::vector<ReportMarginLevel>& margins,
+                               ReportServerInterface*          server,
+                               std::vector<MarginCallEntry>&   entries);
+
+    static void ResolveByScan(std::vector<ReportMarginLevel>&   margins,
+                              std::vector<ReportAccountRecord>& accounts,
+                              std::vector<MarginCallEntry>&     entries);
+};
@@ -0,0 +1,73 @@
+#include "GroupIndex.h"
+
+GroupIndex::GroupIndex() {
+    _currencies.emplace_back(kUnknownCurrencyName);
+    _currency_ids.emplace(kUnknownCurrencyName, kUnknownCurrency);
+}
+
+GroupIndex::GroupIndex(const std::vector<ReportGroupRecord>& groups) : GroupIndex() {
+    Build(groups);
+}
+
+void GroupIndex::Build(const std::vector<ReportGroupRecord>& groups) {
+    _groups.reserve(_groups.size() + groups.size());
+    _group_ids.reserve(_group_ids.size() + groups.size());
+
+    for (const auto& group : groups) {
+        // Первая запись с таким именем выигрывает - как и при линейном поиске
+        if (_group_ids.find(std::string_view(group.group)) != _group_ids.end()) {
+            continue;
+        }
+
+        GroupInfo info;
+        info.name           = group.group;
+        info.currency_id    = InternCurrency(group.currency);
+        info.margin_call    = group.margin_call;
+        info.margin_stopout = group.margin_stopout;
+        info.margin_mode    = group.margin_mode;
+
+        _group_ids.emplace(info.name, static_cast<GroupId>(_groups.size()));
+        _groups.push_back(std::move(info));
+    }
+}
+
+GroupId GroupIndex::Find(std::string_view group_name) const {
+    const auto it = _group_ids.find(group_name);
+    return it == _group_ids.end() ? kUnknownGroup : it->second;
+}
+
+CurrencyId GroupIndex::GetCurrencyId(std::string_view group_name) const {
+    const GroupId group_id = Find(group_name);
+    return group_id == kUnknownGroup ? kUnknownCurrency : _groups[group_id].currency_id;
+}
+
+CurrencyId GroupIndex::InternCurrency(std::string_view currency) {
+    const auto it = _currency_ids.find(currency);
+    if (it != _currency_ids.end()) {
+        return it->second;
+    }
+
+    const auto currency_id = static_cast<CurrencyId>(_currencies.size());
+    _currencies.emplace_back(currency);
+    _currency_ids.emplace(_currencies.back(), currency_id);
+    return currency_id;
+}
+
+size_t GroupIndex::MemoryUsage() const {
+    // Узел unordered_map: ключ, значение, хеш и указатель на следующий узел
+    constexpr size_t kNodeOverhead = sizeof(std::string) + 2 * sizeof(void*) + sizeof(size_t);
+
+    size_t bytes = _groups.capacity() * sizeof(GroupInfo) +
+                   _currencies.capacity() * sizeof(std::string) +
+                   (_group_ids.bucket_count() + _currency_ids.bucket_count()) * sizeof(void*) +
+                   (_group_ids.size() + _currency_ids.size()) * kNodeOverhead;
+
+    for (const GroupInfo& group : _groups) {
+        bytes += 2 * group.name.capacity();
+    }
+    for (const std::string& currency : _currencies) {
+        bytes += 2 * currency.capacity();
+    }
+
+    return bytes;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "model/ReportGroup.hpp"
+
+using GroupId    = uint32_t;
+using CurrencyId = uint32_t;
+
+// Атрибуты группы, которые нужны отчету на каждую строку
+struct GroupInfo {
+    std::string name;
+    CurrencyId  currency_id    = 0;
+    int         margin_call    = 0;
+    int         margin_stopout = 0;
+    int         margin_mode    = 0;
+};
+
+// Group metadata built once per request from GetAllGroups.
+// Group names and currencies are interned into dense ids, lookups by name are O(1) and do not
+// allocate (heterogeneous lookup by std::string_view).
+class GroupIndex {
+public:
+    static constexpr GroupId     kUnknownGroup        = std::numeric_limits<GroupId>::max();
+    static constexpr CurrencyId  kUnknownCurrency     = 0;
+    static constexpr const char* kUnknownCurrencyName = "N/A";
+
+    GroupIndex();
+
+    explicit GroupIndex(const std::vector<ReportGroupRecord>& groups);
+
+    void Build(const std::vector<ReportGroupRecord>& groups);
+
+    [[nodiscard]] GroupId Find(std::string_view group_name) const;
+
+    [[nodiscard]] const GroupInfo& Get(const GroupId group_id) const { return _groups[group_id]; }
+
+    // Currency of the group, kUnknownCurrency ("N/A") if the group is not found
+    [[nodiscard]] CurrencyId GetCurrencyId(std::string_view group_name) const;
+
+    [[nodiscard]] CurrencyId InternCurrency(std::string_view currency);
+
+    [[nodiscard]] const std::string& GetCurrencyName(const CurrencyId currency_id) const {
+        return _currencies[currency_id];
+    }
+
+    [[nodiscard]] size_t GroupsCount() const { return _groups.size(); }
+
+    [[nodiscard]] size_t CurrenciesCount() const { return _currencies.size(); }
+
+    // Имена валют по CurrencyId (kUnknownCurrency - "N/A")
+    [[nodiscard]] const std::vector<std::string>& Currencies() const { return _currencies; }
+
+    // Примерный объем памяти индекса (для лимита SnapshotCache)
+    [[nodiscard]] size_t MemoryUsage() const;
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    using NameMap = std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>>;
+
+    std::vector<GroupInfo>   _groups;
+    NameMap                  _group_ids;
+    std::vector<std::string> _currencies;
+    NameMap                  _currency_ids;
+};
@@ -0,0 +1,147 @@
+#include "GroupMask.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    std::string_view TrimSpaces(std::string_view value) {
+        while (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && value.back() == ' ') {
+            value.remove_suffix(1);
+        }
+        return value;
+    }
+} // namespace
+
+GroupMask::GroupMask(std::string_view mask) : _mask(mask) {
+    size_t begin = 0;
+    while (begin <= mask.size()) {
+        size_t end = mask.find(',', begin);
+        if (end == std::string_view::npos) {
+            end = mask.size();
+        }
+
+        std::string_view pattern = TrimSpaces(mask.substr(begin, end - begin));
+        begin                    = end + 1;
+
+        if (pattern.empty()) {
+            continue;
+        }
+
+        const bool exclude = pattern.front() == '!';
+        if (exclude) {
+            pattern.remove_prefix(1);
+        }
+
+        auto& literals = exclude ? _exclude_literals : _include_literals;
+        auto& patterns = exclude ? _exclude_patterns : _include_patterns;
+
+        if (pattern.find('*') == std::string_view::npos) {
+            literals.emplace(pattern);
+        } else {
+            patterns.push_back(CompilePattern(pattern));
+        }
+    }
+
+    // Шаблон из одних '*' подходит любой группе
+    for (const Pattern& pattern : _include_patterns) {
+        if (pattern.min_size == 0) {
+            _matches_all = _exclude_literals.empty() && _exclude_patterns.empty();
+            break;
+        }
+    }
+}
+
+std::shared_ptr<const GroupMask> GroupMask::Compile(const std::string& mask) {
+    static std::mutex                                                       mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const GroupMask>> masks;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const auto it = masks.find(mask); it != masks.end()) {
+            return it->second;
+        }
+    }
+
+    auto compiled = std::make_shared<const GroupMask>(mask);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (masks.size() >= kMaxCachedMasks) {
+        masks.clear();
+    }
+    masks.emplace(mask, compiled);
+    return compiled;
+}
+
+bool GroupMask::Matches(std::string_view group) const {
+    if (_matches_all) {
+        return true;
+    }
+
+    if (!_exclude_literals.empty() && _exclude_literals.count(group) != 0) {
+        return false;
+    }
+    for (const Pattern& pattern : _exclude_patterns) {
+        if (MatchPattern(pattern, group)) {
+            return false;
+        }
+    }
+
+    if (!_include_literals.empty() && _include_literals.count(group) != 0) {
+        return true;
+    }
+    for (const Pattern& pattern : _include_patterns) {
+        if (MatchPattern(pattern, group)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+GroupMask::Pattern GroupMask::CompilePattern(std::string_view pattern) {
+    Pattern compiled;
+
+    const size_t first = pattern.find('*');
+    const size_t last  = pattern.rfind('*');
+    compiled.prefix    = pattern.substr(0, first);
+    compiled.suffix    = pattern.substr(last + 1);
+
+    // Литералы между '*'; пустые (подряд идущие '*') ничего не дают
+    size_t begin = first + 1;
+    while (begin <= last) {
+        const size_t end = pattern.find('*', begin);
+        if (end > begin) {
+            compiled.middle.emplace_back(pattern.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+
+    compiled.min_size = compiled.prefix.size() + compiled.suffix.size();
+    for (const std::string& segment : compiled.middle) {
+        compiled.min_size += segment.size();
+    }
+    return compiled;
+}
+
+bool GroupMask::MatchPattern(const Pattern& pattern, std::string_view group) {
+    if (group.size() < pattern.min_size || !group.starts_with(pattern.prefix) ||
+        !group.ends_with(pattern.suffix)) {
+        return false;
+    }
+
+    // Между префиксом и суффиксом сегменты ищутся по порядку, каждый - как можно левее:
+    // для шаблонов из одних '*' и литералов это не теряет совпадений
+    std::string_view rest =
+        group.substr(pattern.prefix.size(),
+                     group.size() - pattern.prefix.size() - pattern.suffix.size());
+    for (const std::string& segment : pattern.middle) {
+        const size_t position = rest.find(segment);
+        if (position == std::string_view::npos) {
+            return false;
+        }
+        rest.remove_prefix(position + segment.size());
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Group mask of the report server compiled once and matched locally: comma separated patterns
+// with '*' wildcards and '!' exclusions, spaces around patterns ignored. A group matches when no
+// exclusion and at least one pattern matches it, whatever the order of the patterns.
+//
+// These are the semantics of FakeReportServer; agreement with the MatchWildCardGroup of a real
+// server is checked by the group_mask_capture test on recorded answers. Until that test has
+// passed against a production capture, nothing in the report decides access or row visibility
+// with GroupMask: validators and the margin-call set ask the server.
+//
+// Patterns without '*' go into a hash set, the rest are split into literal segments at '*'
+// (prefix, ordered middle segments, suffix), so a match is a few memcmp without backtracking.
+// Compile() caches compiled masks by their text; the __access.groups of a desk repeats on every
+// request.
+class GroupMask {
+public:
+    // Скомпилированных масок в кэше Compile() не больше; при переполнении кэш очищается
+    static constexpr size_t kMaxCachedMasks = 1024;
+
+    explicit GroupMask(std::string_view mask);
+
+    static std::shared_ptr<const GroupMask> Compile(const std::string& mask);
+
+    [[nodiscard]] bool Matches(std::string_view group) const;
+
+    // "*" без исключений: подходит любая группа
+    [[nodiscard]] bool MatchesAll() const { return _matches_all; }
+
+    [[nodiscard]] const std::string& Text() const { return _mask; }
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    using Literals = std::unordered_set<std::string, StringHash, std::equal_to<>>;
+
+    struct Pattern {
+        std::string              prefix;
+        std::vector<std::string> middle;
+        std::string              suffix;
+        size_t                   min_size = 0; // сумма длин литералов
+    };
+
+    static Pattern CompilePattern(std::string_view pattern);
+
+    static bool MatchPattern(const Pattern& pattern, std::string_view group);
+
+    std::string          _mask;
+    Literals             _include_literals;
+    std::vector<Pattern> _include_patterns;
+    Literals             _exclude_literals;
+    std::vector<Pattern> _exclude_patterns;
+    bool                 _matches_all = false;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Flat open-addressing hash index login -> position in a caller-owned record vector.
+// Keys and payload live in two parallel arrays (SoA), probing is linear, no per-node allocation.
+class LoginIndex {
+public:
+    static constexpr uint32_t kNotFound = std::numeric_limits<uint32_t>::max();
+
+    LoginIndex() = default;
+
+    explicit LoginIndex(size_t expected_size) { Reserve(expected_size); }
+
+    // Prepares the table for expected_size logins, load factor is kept at or below 1/2
+    void Reserve(size_t expected_size) {
+        size_t capacity = kMinCapacity;
+        while (capacity < expected_size * 2) {
+            capacity <<= 1;
+        }
+
+        if (capacity > _logins.size()) {
+            Rehash(capacity);
+        }
+    }
+
+    // Returns false if the login is already indexed, the stored position is kept
+    bool Insert(const int login, const uint32_t position) {
+        if ((_size + 1) * 2 > _logins.size()) {
+            Rehash(_logins.empty() ? kMinCapacity : _logins.size() * 2);
+        }
+
+        size_t slot = Slot(login);
+        while (_positions[slot] != kNotFound) {
+            if (_logins[slot] == login) {
+                return false;
+            }
+            slot = (slot + 1) & _mask;
+        }
+
+        _logins[slot]    = login;
+        _positions[slot] = position;
+        ++_size;
+        return true;
+    }
+
+    [[nodiscard]] uint32_t Find(const int login) const {
+        if (_size == 0) {
+            return kNotFound;
+        }
+
+        size_t slot = Slot(login);
+        while (_positions[slot] != kNotFound) {
+            if (_logins[slot] == login) {
+                return _positions[slot];
+            }
+            slot = (slot + 1) & _mask;
+        }
+        return kNotFound;
+    }
+
+    [[nodiscard]] bool Contains(const int login) const { return Find(login) != kNotFound; }
+
+    // Returns false if the login is not indexed. Deletion shifts the following entries of the
+    // probe chain back instead of leaving tombstones, so lookups stay as short as after Insert
+    bool Erase(const int login) {
+        if (_size == 0) {
+            return false;
+        }
+
+        size_t slot = Slot(login);
+        while (_positions[slot] != kNotFound && _logins[slot] != login) {
+            slot = (slot + 1) & _mask;
+        }
+
+        if (_positions[slot] == kNotFound) {
+            return false;
+        }
+
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & _mask; _positions[next] != kNotFound;
+             next = (next + 1) & _mask) {
+            // Запись может занять дыру, только если ее домашний слот не лежит между дырой и ней
+            const size_t home = Slot(_logins[next]);
+            if (((next - home) & _mask) >= ((next - hole) & _mask)) {
+                _logins[hole]    = _logins[next];
+                _positions[hole] = _positions[next];
+                hole             = next;
+            }
+        }
+
+        _positions[hole] = kNotFound;
+        --_size;
+        return true;
+    }
+
+    [[nodiscard]] size_t Size() const { return _size; }
+
+    [[nodiscard]] bool Empty() const { return _size == 0; }
+
+    void Clear() {
+        _logins.clear();
+        _positions.clear();
+        _mask  = 0;
+        _shift = 32;
+        _size  = 0;
+    }
+
+private:
+    static constexpr size_t kMinCapacity = 16;
+
+    std::vector<int>      _logins;
+    std::vector<uint32_t> _positions; // kNotFound marks an empty slot
+    size_t                _mask  = 0;
+    int                   _shift = 32;
+    size_t                _size  = 0;
+
+    // Fibonacci hashing: logins are mostly sequential, the high bits of the product spread them
+    [[nodiscard]] size_t Slot(const int login) const {
+        return static_cast<size_t>((static_cast<uint32_t>(login) * 0x9E3779B9u) >> _shift);
+    }
+
+    void Rehash(const size_t capacity) {
+        std::vector<int>      old_logins    = std::move(_logins);
+        std::vector<uint32_t> old_positions = std::move(_positions);
+
+        _logins.assign(capacity, 0);
+        _positions.assign(capacity, kNotFound);
+        _mask = capacity - 1;
+
+        _shift = 32;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            --_shift;
+        }
+
+        for (size_t i = 0; i < old_positions.size(); ++i) {
+            if (old_positions[i] == kNotFound) {
+                continue;
+            }
+
+            size_t slot = Slot(old_logins[i]);
+            while (_positions[slot] != kNotFound) {
+                slot = (slot + 1) & _mask;
+            }
+            _logins[slot]    = old_logins[i];
+            _positions[slot] = old_positions[i];
+        }
+    }
+};
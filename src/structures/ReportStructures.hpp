@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "model/ReportAccount.hpp"
+
 struct Total {
     double balance     = 0.0;
     double credit      = 0.0;
@@ -11,4 +13,10 @@ struct Total {
     double margin_free = 0.0;
 };
 
-enum { MARGINLEVEL_OK = 0, MARGINLEVEL_MARGINCALL, MARGINLEVEL_STOPOUT };
\ No newline at end of file
+// Account in margin call / stop out, joined with the account details the report needs
+struct MarginCallEntry {
+    ReportMarginLevel margin;
+    std::string       name;
+};
+
+enum { MARGINLEVEL_OK = 0, MARGINLEVEL_MARGINCALL, MARGINLEVEL_STOPOUT };
@@ -1,86 +1,125 @@
 #include "Utils.h"
 
+#include <cstdlib>
+
+#include "ast/Decimal.hpp"
+
 namespace utils {
     void CreateUI(const ast::Node&                    node,
                   rapidjson::Value&                   response,
                   rapidjson::Document::AllocatorType& allocator) {
-        // Content
         Value node_object(kObjectType);
         to_json(node, node_object, allocator);
 
-        Value content_array(kArrayType);
-        content_array.PushBack(node_object, allocator);
+        CreateUI(node_object, response, allocator);
+    }
 
-        // Header
-        Value header_array(kArrayType);
+    void CreateUI(ast::Node&&                         node,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator) {
+        Value node_object(kObjectType);
+        to_json(std::move(node), node_object, allocator);
 
-        {
-            Value space_object(kObjectType);
-            space_object.AddMember("type", "Space", allocator);
+        CreateUI(node_object, response, allocator);
+    }
 
-            Value children(kArrayType);
+    const Document& ModalChrome() {
+        static const Document chrome = [] {
+            Document document(kObjectType);
+            auto&    allocator = document.GetAllocator();
 
-            Value text_object(kObjectType);
-            text_object.AddMember("type", "#text", allocator);
+            // Header
+            Value header_array(kArrayType);
 
-            Value props(kObjectType);
-            props.AddMember("value", "Margin Call report", allocator);
+            {
+                Value space_object(kObjectType);
+                space_object.AddMember("type", "Space", allocator);
 
-            text_object.AddMember("props", props, allocator);
-            children.PushBack(text_object, allocator);
+                Value children(kArrayType);
 
-            space_object.AddMember("children", children, allocator);
+                Value text_object(kObjectType);
+                text_object.AddMember("type", "#text", allocator);
 
-            header_array.PushBack(space_object, allocator);
-        }
+                Value props(kObjectType);
+                props.AddMember("value", "Margin Call report", allocator);
 
-        // Footer
-        Value footer_array(kArrayType);
+                text_object.AddMember("props", props, allocator);
+                children.PushBack(text_object, allocator);
 
-        {
-            Value space_object(kObjectType);
-            space_object.AddMember("type", "Space", allocator);
+                space_object.AddMember("children", children, allocator);
 
-            Value props_space(kObjectType);
-            props_space.AddMember("justifyContent", "space-between", allocator);
-            space_object.AddMember("props", props_space, allocator);
+                header_array.PushBack(space_object, allocator);
+            }
 
-            Value children(kArrayType);
+            // Footer
+            Value footer_array(kArrayType);
 
-            Value btn_object(kObjectType);
-            btn_object.AddMember("type", "Button", allocator);
+            {
+                Value space_object(kObjectType);
+                space_object.AddMember("type", "Space", allocator);
 
-            Value btn_props_object(kObjectType);
-            btn_props_object.AddMember("className", "form_action_button", allocator);
-            btn_props_object.AddMember("borderType", "danger", allocator);
-            btn_props_object.AddMember("buttonType", "outlined", allocator);
+                Value props_space(kObjectType);
+                props_space.AddMember("justifyContent", "space-between", allocator);
+                space_object.AddMember("props", props_space, allocator);
 
-            btn_props_object.AddMember("onClick", "{\"action\":\"CloseModal\"}", allocator);
+                Value children(kArrayType);
 
-            btn_object.AddMember("props", btn_props_object, allocator);
+                Value btn_object(kObjectType);
+                btn_object.AddMember("type", "Button", allocator);
 
-            Value btn_children(kArrayType);
+                Value btn_props_object(kObjectType);
+                btn_props_object.AddMember("className", "form_action_button", allocator);
+                btn_props_object.AddMember("borderType", "danger", allocator);
+                btn_props_object.AddMember("buttonType", "outlined", allocator);
 
-            Value text_object(kObjectType);
-            text_object.AddMember("type", "#text", allocator);
+                btn_props_object.AddMember("onClick", "{\"action\":\"CloseModal\"}", allocator);
 
-            Value text_props_object(kObjectType);
-            text_props_object.AddMember("value", "Close", allocator);
+                btn_object.AddMember("props", btn_props_object, allocator);
 
-            text_object.AddMember("props", text_props_object, allocator);
-            btn_children.PushBack(text_object, allocator);
+                Value btn_children(kArrayType);
 
-            btn_object.AddMember("children", btn_children, allocator);
+                Value text_object(kObjectType);
+                text_object.AddMember("type", "#text", allocator);
 
-            children.PushBack(btn_object, allocator);
+                Value text_props_object(kObjectType);
+                text_props_object.AddMember("value", "Close", allocator);
 
-            space_object.AddMember("children", children, allocator);
+                text_object.AddMember("props", text_props_object, allocator);
+                btn_children.PushBack(text_object, allocator);
 
-            footer_array.PushBack(space_object, allocator);
-        }
+                btn_object.AddMember("children", btn_children, allocator);
+
+                children.PushBack(btn_object, allocator);
+
+                space_object.AddMember("children", children, allocator);
+
+                footer_array.PushBack(space_object, allocator);
+            }
+
+            document.AddMember("headerContent", header_array, allocator);
+            document.AddMember("footerContent", footer_array, allocator);
+            return document;
+        }();
+
+        return chrome;
+    }
+
+    void CreateUI(rapidjson::Value&                   content,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator) {
+        const Document& chrome = ModalChrome();
+
+        // Content
+        Value content_array(kArrayType);
+        content_array.PushBack(content, allocator);
+
+        // Header and footer
+        Value header_array(chrome["headerContent"], allocator);
+        Value footer_array(chrome["footerContent"], allocator);
 
         // Modal
         Value model_object(kObjectType);
+        model_object.MemberReserve(4, allocator);
         model_object.AddMember("size", "xxxl", allocator);
         model_object.AddMember("headerContent", header_array, allocator);
         model_object.AddMember("footerContent", footer_array, allocator);
@@ -104,20 +143,14 @@ namespace utils {
     }
 
     double TruncateDouble(const double& value, const int& digits) {
+        if (digits >= 0 && digits <= Decimal::kMaxDigits) {
+            return Decimal::Truncate(value, digits).ToDouble();
+        }
+
         const double factor = std::pow(10.0, digits);
         return std::trunc(value * factor) / factor;
     }
 
-    std::string GetGroupCurrencyByName(const std::vector<ReportGroupRecord>& group_vector,
-                                       const std::string&                    group_name) {
-        for (const auto& group : group_vector) {
-            if (group.group == group_name) {
-                return group.currency;
-            }
-        }
-        return "N/A"; // группа не найдена - валюта не определена
-    }
-
     std::string Trim(const std::string& str) {
         const auto begin = str.find_first_not_of(" \t");
         if (begin == std::string::npos)
@@ -137,4 +170,39 @@ namespace utils {
         }
         return out;
     }
+
+    bool IsFlagEnabled(const rapidjson::Value& request, const char* name) {
+        if (!request.IsObject()) {
+            return false;
+        }
+
+        const auto it = request.FindMember(name);
+        if (it == request.MemberEnd()) {
+            return false;
+        }
+
+        const rapidjson::Value& flag = it->value;
+        if (flag.IsBool()) {
+            return flag.GetBool();
+        }
+        if (flag.IsNumber()) {
+            return flag.GetDouble() != 0.0;
+        }
+        if (flag.IsString()) {
+            const std::string value = flag.GetString();
+            return value == "true" || value == "1";
+        }
+        return false;
+    }
+
+    size_t EnvironmentValue(const char* name, const size_t default_value) {
+        const char* value = std::getenv(name);
+        if (value == nullptr || *value == '\0') {
+            return default_value;
+        }
+
+        char*                    end    = nullptr;
+        const unsigned long long parsed = std::strtoull(value, &end, 10);
+        return *end == '\0' ? static_cast<size_t>(parsed) : default_value;
+    }
 } // namespace utils
\ No newline at end of file
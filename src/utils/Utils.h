@@ -17,15 +17,56 @@ namespace utils {
                   rapidjson::Value&                   response,
                   rapidjson::Document::AllocatorType& allocator);
 
+    // Consuming variant: the tree is released while it is written
+    void CreateUI(ast::Node&&                         node,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator);
+
+    // content is moved into the modal, the value is left null
+    void CreateUI(rapidjson::Value&                   content,
+                  rapidjson::Value&                   response,
+                  rapidjson::Document::AllocatorType& allocator);
+
+    // Шапка и подвал модального окна ({"headerContent": [...], "footerContent": [...]}):
+    // собираются один раз за загрузку плагина, строки в них - ссылки на литералы
+    const rapidjson::Document& ModalChrome();
+
+    // SAX-вариант CreateUI: пишет значение response["ui"] в handler, содержимое модального
+    // окна - вызов write_content(handler)
+    template <typename Handler, typename WriteContent>
+    bool WriteUI(Handler& handler, WriteContent&& write_content) {
+        const rapidjson::Document& chrome = ModalChrome();
+
+        return handler.StartObject() &&
+               handler.Key("modal", 5, false) &&
+               handler.StartObject() &&
+               handler.Key("size", 4, false) &&
+               handler.String("xxxl", 4, false) &&
+               handler.Key("headerContent", 13, false) &&
+               chrome["headerContent"].Accept(handler) &&
+               handler.Key("footerContent", 13, false) &&
+               chrome["footerContent"].Accept(handler) &&
+               handler.Key("content", 7, false) &&
+               handler.StartArray() &&
+               write_content(handler) &&
+               handler.EndArray(1) &&
+               handler.EndObject(4) &&
+               handler.EndObject(1);
+    }
+
     std::string FormatTimestampToString(const time_t&      timestamp,
                                         const std::string& format = "%Y.%m.%d %H:%M:%S");
 
     double TruncateDouble(const double& value, const int& digits);
 
-    std::string GetGroupCurrencyByName(const std::vector<ReportGroupRecord>& group_vector,
-                                       const std::string&                    group_name);
-
     std::string Trim(const std::string& str);
 
     std::set<std::string> SplitToSet(const std::string& str);
+
+    // Опциональный флаг запроса: true, ненулевое число или строка "true"/"1"
+    bool IsFlagEnabled(const rapidjson::Value& request, const char* name);
+
+    // Числовая настройка из окружения (MARGINCALL_*): без переменной, пустая или не число -
+    // default_value
+    size_t EnvironmentValue(const char* name, size_t default_value);
 } // namespace utils
\ No newline at end of file
@@ -57,6 +57,53 @@ ValidationResult RequestValidator::ValidateRequest(ReportType              repor
     }
 }
 
+ValidationResult RequestValidator::ValidateGroups(const ReportType       report_type,
+                                                  const char*            validator_name,
+                                                  const std::string&     access_groups,
+                                                  const std::string&     requested_groups,
+                                                  ReportServerInterface* server) {
+    // Повторная проверка той же пары масок - один поиск в кэше
+    ValidationCache& cache = ValidationCache::Instance();
+    if (std::optional<ValidationResult> cached =
+            cache.Find(report_type, access_groups, requested_groups)) {
+        return std::move(*cached);
+    }
+
+    const uint64_t   generation = cache.Generation();
+    ValidationResult result;
+    result.allowed = true;
+    result.code    = 200;
+    result.message = std::string(validator_name) + ": all groups validated successfully";
+
+    std::set<std::string> groups_set = utils::SplitToSet(requested_groups);
+
+    // Доступ решает сервер: GroupMask сверен с MatchWildCardGroup только на фейковом сервере
+    for (const auto& group : groups_set) {
+        int match_result = 0;
+        try {
+            match_result = server->MatchWildCardGroup(access_groups, group);
+        } catch (const std::exception& e) {
+            // Ошибка сервера не запоминается
+            result.allowed = false;
+            result.code    = 404;
+            result.message =
+                std::string(validator_name) + ": MatchWildCardGroup error for group: " + group;
+            return result;
+        }
+
+        // Если хотя бы одна группа не прошла проверку
+        if (match_result != 0) {
+            result.allowed = false;
+            result.code    = 403;
+            result.message = std::string(validator_name) + ": access denied for group: " + group;
+            break;
+        }
+    }
+
+    cache.Insert(generation, report_type, access_groups, requested_groups, result);
+    return result;
+}
+
 ValidationResult RequestValidator::ValidateNone(const rapidjson::Value& request,
                                                 ReportServerInterface*  server) {
     ValidationResult result;
@@ -111,33 +158,11 @@ ValidationResult RequestValidator::ValidateDailyGroup(const rapidjson::Value& re
         return result;
     }
 
-    std::set<std::string> groups_set = utils::SplitToSet(requested_groups);
-
-    for (const auto& group : groups_set) {
-        int match_result = 0;
-        try {
-            match_result = server->MatchWildCardGroup(access_groups, group);
-        } catch (const std::exception& e) {
-            result.allowed = false;
-            result.code    = 404;
-            result.message = "ValidateDailyGroup: MatchWildCardGroup error for group: " + group;
-            return result;
-        }
-
-        // Если хотя бы одна группа не прошла проверку
-        if (match_result != 0) {
-            result.allowed = false;
-            result.code    = 403;
-            result.message = "ValidateDailyGroup: access denied for group: " + group;
-            return result;
-        }
-    }
-
-    // Все группы прошли проверку
-    result.allowed = true;
-    result.code    = 200;
-    result.message = "ValidateDailyGroup: all groups validated successfully";
-    return result;
+    return ValidateGroups(ReportType::DailyGroup,
+                          "ValidateDailyGroup",
+                          access_groups,
+                          requested_groups,
+                          server);
 }
 
 ValidationResult RequestValidator::ValidateAccount(const rapidjson::Value& request,
@@ -194,33 +219,11 @@ ValidationResult RequestValidator::ValidateRangeGroup(const rapidjson::Value& re
         return result;
     }
 
-    std::set<std::string> groups_set = utils::SplitToSet(requested_groups);
-
-    for (const auto& group : groups_set) {
-        int match_result = 0;
-        try {
-            match_result = server->MatchWildCardGroup(access_groups, group);
-        } catch (const std::exception& e) {
-            result.allowed = false;
-            result.code    = 404;
-            result.message = "ValidateRangeGroup: MatchWildCardGroup error for group: " + group;
-            return result;
-        }
-
-        // Если хотя бы одна группа не прошла проверку
-        if (match_result != 0) {
-            result.allowed = false;
-            result.code    = 403;
-            result.message = "ValidateRangeGroup: access denied for group: " + group;
-            return result;
-        }
-    }
-
-    // Все группы прошли проверку
-    result.allowed = true;
-    result.code    = 200;
-    result.message = "ValidateRangeGroup: all groups validated successfully";
-    return result;
+    return ValidateGroups(ReportType::RangeGroup,
+                          "ValidateRangeGroup",
+                          access_groups,
+                          requested_groups,
+                          server);
 }
 
 ValidationResult RequestValidator::ValidateGroup(const rapidjson::Value& request,
@@ -245,33 +248,11 @@ ValidationResult RequestValidator::ValidateGroup(const rapidjson::Value& request
         return result;
     }
 
-    std::set<std::string> groups_set = utils::SplitToSet(requested_groups);
-
-    for (const auto& group : groups_set) {
-        int match_result = 0;
-        try {
-            match_result = server->MatchWildCardGroup(access_groups, group);
-        } catch (const std::exception& e) {
-            result.allowed = false;
-            result.code    = 404;
-            result.message = "ValidateGroup: MatchWildCardGroup error for group: " + group;
-            return result;
-        }
-
-        // Если хотя бы одна группа не прошла проверку
-        if (match_result != 0) {
-            result.allowed = false;
-            result.code    = 403;
-            result.message = "ValidateGroup: access denied for group: " + group;
-            return result;
-        }
-    }
-
-    // Все группы прошли проверку
-    result.allowed = true;
-    result.code    = 200;
-    result.message = "ValidateGroup: all groups validated successfully";
-    return result;
+    return ValidateGroups(ReportType::Group,
+                          "ValidateGroup",
+                          access_groups,
+                          requested_groups,
+                          server);
 }
 
 ValidationResult RequestValidator::ValidateDaily(const rapidjson::Value& request,
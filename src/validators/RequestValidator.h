@@ -4,6 +4,7 @@
 #include <string>
 
 #include "ReportServerInterface.h"
+#include "caches/ValidationCache.h"
 #include "rapidjson/document.h"
 #include "structures/ReportType.h"
 #include "structures/ValidationResult.h"
@@ -16,6 +17,14 @@ public:
                                             ReportServerInterface*  server);
 
 private:
+    // Проверка requested_groups по маске доступа, общая для *Group-валидаторов; результат
+    // запоминается в ValidationCache
+    static ValidationResult ValidateGroups(ReportType             report_type,
+                                           const char*            validator_name,
+                                           const std::string&     access_groups,
+                                           const std::string&     requested_groups,
+                                           ReportServerInterface* server);
+
     static ValidationResult ValidateNone(const rapidjson::Value& request,
                                          ReportServerInterface*  server);
 